@@ -3,7 +3,7 @@
 ROOT=$PWD
 DATA_DIR=$ROOT/data
 ARGS="-Wall -pthread -O2"
-INCLUDES=$ROOT/programs/bench-tools/benchmark.cpp
+INCLUDES="$ROOT/programs/bench-tools/benchmark.cpp $ROOT/programs/bench-tools/histogram.cpp $ROOT/programs/bench-tools/topology.cpp $ROOT/programs/bench-tools/thread-pool.cpp $ROOT/programs/bench-tools/clock.cpp $ROOT/programs/bench-tools/calibration.cpp $ROOT/programs/bench-tools/cpu-time.cpp $ROOT/programs/bench-tools/perf-counters.cpp $ROOT/programs/bench-tools/timeline.cpp $ROOT/programs/bench-tools/trace.cpp $ROOT/programs/bench-tools/result-file.cpp $ROOT/programs/bench-tools/statistics.cpp $ROOT/programs/bench-tools/warmup.cpp $ROOT/programs/bench-tools/registry.cpp $ROOT/programs/bench-tools/config.cpp $ROOT/programs/bench-tools/sweep.cpp $ROOT/programs/bench-tools/scaling.cpp $ROOT/programs/bench-tools/arrival.cpp $ROOT/programs/bench-tools/pacer.cpp $ROOT/programs/bench-tools/io-uring.cpp $ROOT/programs/bench-tools/io-batching.cpp $ROOT/programs/bench-tools/buffer-arena.cpp"
 IS_OCCLUM=false
 OCCLUM_DIRECTORY=/tmp/occlum_instance
 GRAMINE_DIRECTORY=/tmp/gramine_instance
@@ -22,6 +22,12 @@ fi
 
 # create config directory
 mkdir -p $CONFIG_DIRECTORY
+
+# build the converter for binary result files, it runs outside of the enclaves
+if [[ $# -lt 1 || "$1" = "bench-export" ]] && [ -x "$(command -v g++)" ]; then
+    echo "[INFO]: Compiling bench-export..."
+    g++ $ARGS -o $ROOT/programs/bench-export/bench-export $INCLUDES $ROOT/programs/bench-export/main.cpp
+fi
 cd $ROOT/programs/benchmark-routines
 
 # build binaries
@@ -67,3 +73,42 @@ for d in */ ; do
         echo "[WARN]: No \"main.c\" found in $d!"
     fi
 done
+
+# build the single bench binary that links all routines, e.g. "bench/linux --run 'write*,read'"
+if [[ $# -lt 1 || "$1" = "bench" ]]; then
+    cd $ROOT/programs
+    ROUTINES=$(ls benchmark-routines/*/main.cpp)
+    echo "[INFO]: Compiling bench..."
+    if [ "$IS_OCCLUM" = "true" ]; then
+        occlum-g++ $ARGS -DBENCH_SINGLE_BINARY -o $OCCLUM_DIRECTORY/image/bin/bench $INCLUDES $ROUTINES bench/main.cpp
+        printf "#!/bin/sh\n" > bench/occlum
+        printf "set -e\n" >> bench/occlum
+        printf "cd $OCCLUM_DIRECTORY\n" >> bench/occlum
+        printf "cp -R $CONFIG_DIRECTORY $OCCLUM_DIRECTORY/image/tmp/\n" >> bench/occlum
+        printf "occlum build\n" >> bench/occlum
+        printf "occlum run /bin/bench \"\$@\"\n" >> bench/occlum
+        printf "cd $ROOT\n" >> bench/occlum
+        chmod +x bench/occlum
+    else
+        g++ $ARGS -DBENCH_SINGLE_BINARY -o bench/linux $INCLUDES $ROUTINES bench/main.cpp
+        scone-g++ $ARGS -DBENCH_SINGLE_BINARY -o bench/scone-s1 $INCLUDES $ROUTINES bench/main.cpp
+        scone5-g++ $ARGS -DBENCH_SINGLE_BINARY -o bench/scone $INCLUDES $ROUTINES bench/main.cpp
+
+        # create runscript for Gramine, run.sh signs bench/linux as the enclave's main
+        printf "#!/bin/sh\n" > bench/gramine
+        printf "set -e\n" >> bench/gramine
+        printf "cd $GRAMINE_DIRECTORY\n" >> bench/gramine
+        printf "gramine-sgx main \"\$@\" 2>/tmp/gramine-benchmark.log\n" >> bench/gramine
+        printf "cd $ROOT\n" >> bench/gramine
+        chmod +x bench/gramine
+    fi
+fi
+
+# build and run the tests of the shared code, e.g. "./build.sh tests"
+if [ "$1" = "tests" ]; then
+    cd $ROOT/programs/tests
+    for t in *.cpp; do
+        echo "[INFO]: Testing ${t%.cpp}..."
+        g++ $ARGS -o /tmp/${t%.cpp} $INCLUDES $t && /tmp/${t%.cpp} || { echo "[ERROR]: ${t%.cpp} failed!"; exit 1; }
+    done
+fi
@@ -1,5 +1,7 @@
 declare type BatchDataObjectBase = {
     environmentVariables: string[];
+    config?: {[key: string]: string|number};
+    unknownConfigKeys?: string[];
     dash?: "solid"|"dot"|"dash"|"longdash"|"dashdot"|"longdashdot";
     color?: number|string;
     name?: string;
@@ -7,16 +9,150 @@ declare type BatchDataObjectBase = {
     lineWidth?: number;
 };
 
+export type LatencyHistogramDataObject = {
+    numSamples: number;
+    mean: number;
+    min: number;
+    p50: number;
+    p90: number;
+    p99: number;
+    p999: number;
+    max: number;
+    bucketsNanoseconds: [number, number][];
+};
+
+export type ClockDataObject = {
+    source: "tsc"|"monotonic";
+    frequency: number;
+    resolutionNanoseconds: number;
+    overheadNanoseconds: number;
+};
+
+export type HarnessOverheadDataObject = {
+    runtimesMicroseconds: number[];
+    runtimeMedian: number;
+    latencyHistogramMicroseconds?: LatencyHistogramDataObject;
+    clockReadDeltasMicroseconds: number[];
+};
+
+export type ThreadUsageSumDataObject = {
+    numThreads: number;
+    usrCpuTimeMicroseconds: number;
+    sysCpuTimeMicroseconds: number;
+    voluntaryContextSwitches: number;
+    nonvoluntaryContextSwitches: number;
+};
+
+export type ThreadAccountingDataObject = {
+    workers: ThreadUsageSumDataObject;
+    others: ThreadUsageSumDataObject;
+    threads: ({
+        tid: number;
+        name: string;
+        worker: boolean;
+    } & Omit<ThreadUsageSumDataObject, "numThreads">)[];
+};
+
+export type TimelineDataObject = {
+    timesMicroseconds: number[];
+    throughputs: number[];
+    cpuUtilizations: number[];
+    changepoints: {
+        index: number;
+        timeMicroseconds: number;
+        metric: "throughput"|"cpuUtilization";
+        meanBefore: number;
+        meanAfter: number;
+    }[];
+};
+
+export type BatchStatisticsDataObject = {
+    numValues: number;
+    mean: number;
+    median: number;
+    mad: number;
+    confidenceLevel: number;
+    ciLower: number;
+    ciUpper: number;
+    relativeHalfWidth: number|null;
+};
+
+export type AdaptiveBatchDataObject = {
+    targetPrecision: number;
+    minBatches: number;
+    maxBatches: number;
+    maxDurationSeconds: number;
+    stopReason: "precision"|"maxBatches"|"maxDuration";
+};
+
 export type ThroughputBatchDataObject = {
+    statistics?: BatchStatisticsDataObject;
+    warmup?: {
+        windowSize: number;
+        tolerance: number;
+        probeExecutions: number;
+        steady: boolean;
+        durationMicroseconds: number;
+        cpuTimeMicroseconds: number;
+        runtimesMicroseconds: number[];
+        cpuTimesMicroseconds: number[];
+    };
+    executionCalibration?: {
+        minBatchDurationMicroseconds: number;
+        steps: [number, number][];
+    };
+    adaptive?: AdaptiveBatchDataObject;
+    numBatches?: number;
     runtimesMicroseconds: number[];
+    correctedRuntimesMicroseconds?: number[];
+    harnessOverheadMicroseconds?: HarnessOverheadDataObject;
     cpuTimesMicroseconds: number[];
+    clock?: ClockDataObject;
+    latencySampleInterval?: number;
+    latencyHistogramsMicroseconds?: LatencyHistogramDataObject[];
+    threadPlacement?: "none"|"compact"|"scatter"|"smt"|"list";
+    threadCpus?: number[][];
+    threadAccounting?: ThreadAccountingDataObject[];
+    perfCounters?: string[];
+    perfCountsPerExecution?: {[counter: string]: number[]};
+    timelines?: TimelineDataObject[];
     numThreads: number;
     numExecutions: number;
+    io?: IoBatchingDataObject;
+    ioUring?: IoUringDataObject;
     type: "TROUGHPUT-BENCHMARK";
 } & BatchDataObjectBase;
 
+export type IoUringDataObject = {
+    queueDepth: number;
+    batchSize: number;
+    sqpoll: boolean;
+    registeredBuffers: boolean;
+    registeredFiles: boolean;
+};
+
+export type IoBatchingDataObject = {
+    variant: "single"|"vectored"|"coalesced";
+    vectors: number;
+    coalesce: number;
+    bytesPerCall: number;
+    syscallsPerByte: number;
+    bytesPerSecond: number[];
+};
+
+export type BufferArenaDataObject = {
+    backing: "heap"|"mmap"|"hugetlb"|"thp";
+    usedBacking: "heap"|"mmap"|"hugetlb"|"thp";
+    alignment: number;
+    prefault: boolean;
+};
+
 export type WriteBatchDataObject = ThroughputBatchDataObject & {
     bufferSize: number;
+    writeMode: "buffered"|"direct"|"dsync"|"direct_dsync";
+    bufferArena: BufferArenaDataObject;
+    io?: IoBatchingDataObject;
+    ioUring?: IoUringDataObject;
 }
 
 export type FrequencyBenchmarkDataObject = {
@@ -28,12 +164,33 @@ export type FrequencyBenchmarkDataObject = {
     runtimeMin: number;
     runtimeMax: number;
     runtimeMedian: number;
+    timeline?: TimelineDataObject;
+    latencyHistogramMicroseconds?: LatencyHistogramDataObject;
+    pacingErrorMicroseconds?: LatencyHistogramDataObject;
+    achievedFrequency?: number;
     targetFrequency: number;
 };
 
 export type FrequencyBatchDataObject = {
     benchmarks: FrequencyBenchmarkDataObject[];
+    clock?: ClockDataObject;
     numThreads: number;
+    loadMode?: "closed"|"open";
+    arrivalProcess?: "constant"|"poisson";
+    pacing?: {
+        mode: "sleep"|"spin"|"hybrid";
+        spinMicroseconds?: number;
+        wakeupLatencyMedianMicroseconds?: number;
+        wakeupLatencyP99Microseconds?: number;
+    };
+    frequencySpacing?: "linear"|"log"|"search";
+    saturation?: {
+        threshold: number;
+        tolerance?: number;
+        frequency: number|null;
+        lastSustainedSample: number|null;
+        firstSaturatedSample: number|null;
+    };
     type: "FREQUENCY-BENCHMARK";
 } & BatchDataObjectBase;
 
@@ -58,6 +215,33 @@ export type LatencyBatchDataObject = {
 
 export type BatchDataObject = ThroughputBatchDataObject|FrequencyBatchDataObject|WriteBatchDataObject|LatencyBatchDataObject;
 
+export type SweepPointDataObject = {
+    parameters: {[key: string]: string|number};
+    status: number;
+    result: ThroughputBatchDataObject|FrequencyBatchDataObject|WriteBatchDataObject|null;
+};
+
+export type ScalingStepDataObject = {
+    numThreads: number;
+    callsPerSecond?: number;
+    latencyMicroseconds?: number;
+    cpuTimePerCallMicroseconds?: number;
+    efficiency?: number;
+};
+
+export type SweepDataObject = {
+    sweepMode: "cartesian"|"list";
+    parameters: string[];
+    points: SweepPointDataObject[];
+    scaling?: {
+        steps: ScalingStepDataObject[];
+        collapseThreshold: number;
+        peakThreads: number|null;
+        collapseThreads: number|null;
+    };
+    type: "SWEEP";
+};
+
 export type RuntimeID = string;
 export type RuntimeObject = {
     id: RuntimeID;
@@ -0,0 +1,246 @@
+#include "../bench-tools/benchmark.h"
+#include "../bench-tools/result-file.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <map>
+#include <set>
+
+/**
+ * @brief All chunks of a column
+ */
+struct Column {
+
+    // the column name as written by ResultWriter
+    std::string name;
+
+    // the chunks by batch (or sample), or the single chunk of a run column
+    std::map<uint32_t, const ResultChunk*> chunks;
+
+};
+
+/**
+ * @brief Writes the values of a chunk as JSON value
+ */
+static void value_to_json( FILE* file, const ResultChunk &chunk ) {
+    const bool is_array = (chunk.type & RESULT_ARRAY) != 0;
+    switch (chunk.type & ~RESULT_ARRAY) {
+        case RESULT_F64:
+        case RESULT_I64:
+            if (is_array) fprintf(file, "[");
+            for (uint32_t i = 0; i < chunk.count; i++) {
+                if ((chunk.type & ~RESULT_ARRAY) == RESULT_F64) fprintf(file, "%.17g", ((const double*)chunk.data)[i]);
+                else fprintf(file, "%lld", (long long)((const int64_t*)chunk.data)[i]);
+                if (i != chunk.count-1) fprintf(file, ", ");
+            }
+            if (is_array) fprintf(file, "]");
+            break;
+        case RESULT_STRING:
+            fprintf(file, "%s", to_json_string(std::string((const char*)chunk.data, chunk.count)).c_str());
+            break;
+        case RESULT_JSON:
+            fwrite(chunk.data, 1, chunk.count, file);
+            break;
+        default:
+            fprintf(file, "null");
+    }
+}
+
+/**
+ * @brief Writes the values of a chunk as CSV cell
+ */
+static void value_to_csv( FILE* file, const ResultChunk &chunk ) {
+    if (chunk.type == RESULT_F64) fprintf(file, "%.17g", *(const double*)chunk.data);
+    else if (chunk.type == RESULT_I64) fprintf(file, "%lld", (long long)*(const int64_t*)chunk.data);
+    else if (chunk.type == RESULT_STRING) fprintf(file, "%s", to_json_string(std::string((const char*)chunk.data, chunk.count)).c_str());
+}
+
+/**
+ * @brief Groups the chunks into run columns and batch columns, both in the
+ * order they were written, and returns the batches that have all batch columns
+ */
+static std::set<uint32_t> get_columns( const ResultReader &reader, std::vector<Column>* run_columns, std::vector<Column>* batch_columns ) {
+    std::map<std::string, unsigned int> run_positions, batch_positions;
+    for (const auto &chunk : reader.m_aChunks) {
+        const bool is_run = chunk.index == RESULT_RUN_INDEX;
+        auto &positions = is_run ? run_positions : batch_positions;
+        auto &columns = is_run ? *run_columns : *batch_columns;
+        if (positions.find(chunk.name) == positions.end()) {
+            positions[chunk.name] = columns.size();
+            columns.push_back({chunk.name, {}});
+        }
+        columns[positions[chunk.name]].chunks[chunk.index] = &chunk;
+    }
+
+    // a crash can leave the last batch incomplete
+    std::set<uint32_t> batches;
+    if (batch_columns->empty()) return batches;
+    for (const auto &it : (*batch_columns)[0].chunks) {
+        bool complete = true;
+        for (const auto &column : *batch_columns) complete &= column.chunks.find(it.first) != column.chunks.end();
+        if (complete) batches.insert(it.first);
+    }
+    return batches;
+}
+
+/**
+ * @brief Writes the results in the JSON schema of Batch::to_json and FrequencyBatch::to_json.
+ * "a.b" columns become the object a with the field b and "a[].b" columns the
+ * array a of objects with the field b
+ */
+static void to_json( FILE* file, const ResultReader &reader ) {
+    std::vector<Column> run_columns, batch_columns;
+    std::vector<std::string> keys;
+    std::map<std::string, std::vector<const Column*>> objects, rows;
+    const Column *type = nullptr, *additional_data = nullptr;
+    const std::set<uint32_t> batches = get_columns(reader, &run_columns, &batch_columns);
+    for (const auto &column : run_columns) {
+        if (column.name == "type") type = &column;
+        if (column.name == "additionalData") additional_data = &column;
+    }
+
+    // the additional data of the routine comes first, like in to_json()
+    fprintf(file, "{\n");
+    if (additional_data != nullptr) {
+        const ResultChunk &chunk = *additional_data->chunks.begin()->second;
+        const std::string fields((const char*)chunk.data, chunk.count);
+        if (fields.size() > 2) fprintf(file, "    %s,\n", fields.substr(1, fields.size()-2).c_str());
+    }
+
+    // group the nested columns by their top level key
+    for (const auto &column : batch_columns) {
+        const size_t row = column.name.find("[].");
+        const size_t dot = column.name.find('.');
+        if (row != std::string::npos) {
+            const std::string key = column.name.substr(0, row);
+            if (rows.find(key) == rows.end()) keys.push_back(key);
+            rows[key].push_back(&column);
+        } else if (dot != std::string::npos) {
+            const std::string key = column.name.substr(0, dot);
+            if (objects.find(key) == objects.end()) keys.push_back(key);
+            objects[key].push_back(&column);
+        } else {
+            keys.push_back(column.name);
+            objects[column.name].push_back(&column);
+        }
+    }
+
+    for (const auto &key : keys) {
+        fprintf(file, "    \"%s\": ", key.c_str());
+        if (rows.find(key) != rows.end()) {
+            const auto &columns = rows[key];
+            fprintf(file, "[");
+            for (auto it = batches.begin(); it != batches.end(); it++) {
+                fprintf(file, "%s{", it == batches.begin() ? "" : ",\n        ");
+                for (unsigned int c = 0; c < columns.size(); c++) {
+                    fprintf(file, "\"%s\": ", columns[c]->name.substr(key.size()+3).c_str());
+                    value_to_json(file, *columns[c]->chunks.at(*it));
+                    if (c != columns.size()-1) fprintf(file, ", ");
+                }
+                fprintf(file, "}");
+            }
+            fprintf(file, "],\n");
+            continue;
+        }
+        const auto &columns = objects[key];
+        const bool is_object = columns[0]->name != key;
+        if (is_object) fprintf(file, "{");
+        for (unsigned int c = 0; c < columns.size(); c++) {
+            if (is_object) fprintf(file, "\"%s\": ", columns[c]->name.substr(key.size()+1).c_str());
+            fprintf(file, "[");
+            for (auto it = batches.begin(); it != batches.end(); it++) {
+                if (it != batches.begin()) fprintf(file, ", ");
+                value_to_json(file, *columns[c]->chunks.at(*it));
+            }
+            fprintf(file, "]");
+            if (c != columns.size()-1) fprintf(file, ",\n        ");
+        }
+        if (is_object) fprintf(file, "}");
+        fprintf(file, ",\n");
+    }
+
+    // the environment variables are part of the additional data if it exists
+    for (const auto &column : run_columns) {
+        if (&column == type || &column == additional_data) continue;
+        if (column.name == "environmentVariables" && additional_data != nullptr) continue;
+        fprintf(file, "    \"%s\": ", column.name.c_str());
+        value_to_json(file, *column.chunks.begin()->second);
+        fprintf(file, ",\n");
+    }
+    fprintf(file, "    \"type\": ");
+    if (type != nullptr) value_to_json(file, *type->chunks.begin()->second);
+    else fprintf(file, "null");
+    fprintf(file, "\n}\n");
+}
+
+/**
+ * @brief Writes one row per batch (or sample) with all scalar columns. The
+ * scalar run columns are repeated in every row, arrays and JSON columns are skipped
+ */
+static void to_csv( FILE* file, const ResultReader &reader ) {
+    std::vector<Column> run_columns, batch_columns;
+    std::vector<const Column*> columns;
+    const std::set<uint32_t> batches = get_columns(reader, &run_columns, &batch_columns);
+    for (const auto &column : batch_columns) columns.push_back(&column);
+    for (const auto &column : run_columns) columns.push_back(&column);
+
+    std::string skipped;
+    fprintf(file, "index");
+    for (auto it = columns.begin(); it != columns.end();) {
+        const uint16_t type = (*it)->chunks.begin()->second->type;
+        if (type != RESULT_F64 && type != RESULT_I64 && type != RESULT_STRING) {
+            skipped += (skipped.empty() ? "" : ", ") + (*it)->name;
+            it = columns.erase(it);
+            continue;
+        }
+        fprintf(file, ",%s", (*it)->name.c_str());
+        it++;
+    }
+    fprintf(file, "\n");
+    if (!skipped.empty()) LOG_INFO("Skipped the non-scalar columns %s\n", skipped.c_str());
+
+    for (const auto batch : batches) {
+        fprintf(file, "%u", batch);
+        for (const auto column : columns) {
+            fprintf(file, ",");
+            value_to_csv(file, *(column->chunks.size() == 1 && column->chunks.begin()->first == RESULT_RUN_INDEX ? column->chunks.begin()->second : column->chunks.at(batch)));
+        }
+        fprintf(file, "\n");
+    }
+}
+
+int main( int argc, char **argv ) {
+
+    ResultReader reader; // the mapped result file
+
+    if (argc != 3) {
+        printf("Usage: %s <result file> <output file (.json or .csv)>\n", argv[0]);
+        return 1;
+    }
+    const std::string output = argv[2];
+    const bool is_csv = output.size() >= 4 && output.compare(output.size()-4, 4, ".csv") == 0;
+    const bool is_json = output.size() >= 5 && output.compare(output.size()-5, 5, ".json") == 0;
+    if (!is_csv && !is_json) {
+        LOG_ERROR("Unknown output file type of \"%s\"! Must be .json or .csv\n", output.c_str());
+        return 1;
+    }
+
+    // read results
+    if (!reader.open(argv[1])) return 1;
+    if (reader.m_bTruncated) LOG_WARN("The result file is truncated, only complete batches are exported\n");
+
+    // convert
+    FILE* file = fopen(output.c_str(), "w");
+    if (file == nullptr) {
+        LOG_ERROR("Could not open file at \"%s\". Error %d: %s\n", output.c_str(), errno, strerror(errno));
+        return 1;
+    }
+    if (is_csv) to_csv(file, reader);
+    else to_json(file, reader);
+    fclose(file);
+
+    // done
+    return 0;
+
+}
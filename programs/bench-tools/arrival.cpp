@@ -0,0 +1,37 @@
+#include "./arrival.h"
+#include "./benchmark.h"
+
+#include <math.h>
+#include <random>
+
+void ArrivalSchedule::generate( double frequency, double duration_micros ) {
+    m_aOffsets.clear();
+    if (frequency <= 0.0 || duration_micros <= 0.0) return;
+    const double gap_micros = 1e6 / frequency;
+    m_aOffsets.reserve(ceil(duration_micros / gap_micros));
+
+    if (m_eProcess == ArrivalProcess::CONSTANT) {
+        for (double t = 0.0; t < duration_micros; t += gap_micros) m_aOffsets.push_back(Clock::from_micros(t));
+        return;
+    }
+
+    // poisson arrivals have exponentially distributed gaps with the mean 1/frequency
+    std::mt19937_64 generator(m_uSeed);
+    std::exponential_distribution<double> gaps(1.0 / gap_micros);
+    for (double t = gaps(generator); t < duration_micros; t += gaps(generator)) m_aOffsets.push_back(Clock::from_micros(t));
+}
+
+const char* ArrivalSchedule::get_process_name() const {
+    return m_eProcess == ArrivalProcess::POISSON ? "poisson" : "constant";
+}
+
+void ArrivalSchedule::process_environment_variables( ArrivalSchedule* schedule ) {
+    if (schedule == nullptr) return;
+
+    // constant spaces the arrivals evenly, poisson draws exponential gaps
+    schedule->m_eProcess = get_config("BM_ARRIVAL_PROCESS", std::string("constant")) == "poisson" ? ArrivalProcess::POISSON : ArrivalProcess::CONSTANT;
+
+    // the seed of the poisson process
+    schedule->m_uSeed = get_config("BM_ARRIVAL_SEED", (long)1);
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+enum class ArrivalProcess {
+    CONSTANT,   // evenly spaced arrivals
+    POISSON     // exponentially distributed gaps between the arrivals
+};
+
+/**
+ * @brief The precomputed start times of the calls of an open-loop run. The
+ * schedule does not depend on how long the calls take, so a slow call delays
+ * the following calls instead of lowering the offered load (no coordinated
+ * omission). The i-th arrival is executed by thread i % num_threads
+ */
+class ArrivalSchedule {
+
+    public:
+
+        // how the gaps between the arrivals are distributed
+        ArrivalProcess m_eProcess = ArrivalProcess::CONSTANT;
+
+        // the seed of the poisson process, the same seed gives the same schedule
+        uint64_t m_uSeed = 1;
+
+        // the start of every arrival in clock ticks after the start of the run
+        std::vector<uint64_t> m_aOffsets;
+
+        /**
+         * @brief Computes the arrivals of the given rate in the given time span
+         *
+         * @param frequency The average amount of arrivals per second
+         * @param duration_micros The time span to schedule in microseconds
+         */
+        void generate( double frequency, double duration_micros );
+
+        /**
+         * @brief Returns the name of the arrival process as written into the results
+         */
+        const char* get_process_name() const;
+
+        /**
+         * @brief Checks the environment variables for matching parameters
+         *
+         * @param schedule [OUT]: The arrival process and its seed
+         */
+        static void process_environment_variables( ArrivalSchedule* schedule );
+
+};
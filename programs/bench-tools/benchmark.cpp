@@ -15,177 +15,151 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
 
 #define BENCHMARK_STAT_FILE "/tmp/stat"
 #define MIN_SLEEP_TIME_MICROSECONDS 500
-#define HZ 100u
+#define DIRECT_IO_BLOCK_SIZE ((size_t)512)
 
 std::vector<std::string> Benchmark::m_aStatFilepaths = {};
+CpuTimeSampler Benchmark::m_oCpuTimeSampler;
+PerfCounters Benchmark::m_oPerfCounters;
+TimelineRecorder Benchmark::m_oTimelineRecorder;
+ThreadPool Benchmark::m_oThreadPool;
+
+struct BenchmarkRun {
+    SpinBarrier start_barrier;
+    SpinBarrier end_barrier;
+    std::vector<int> cpus;
+    std::vector<pid_t> tids;
+    std::vector<double> avg_runtimes;
+    std::vector<LatencyHistogram> histograms;
+    std::vector<LatencyHistogram> pacing_errors;
+    std::function<void()> on_start;
+    std::function<void()> on_end;
+};
 
 bool Benchmark::was_executed() {
     return m_bWasExecuted;
 }
 
+static void null_function( void* self, unsigned int thread_num ) {}
+
+Benchmark* Benchmark::create_null_benchmark() const {
+    Benchmark* benchmark = new Benchmark();
+    benchmark->m_pFunction = null_function;
+    return benchmark;
+}
+
+std::string Benchmark::get_executions_description() const {
+    return m_uNumExecutions == 0 ? "with calibrated executions" : std::to_string(m_uNumExecutions) + " times";
+}
+
 void Benchmark::run() {
 
-    struct timespec t1, t2;
-    std::vector<unsigned long> cpu_usr_t1, cpu_usr_t2, cpu_sys_t1, cpu_sys_t2;
+    uint64_t t1, t2;
+    CpuTimeSnapshot cpu_t1, cpu_t2;
+    std::vector<double> perf_t1, perf_t2;
     if (m_uNumThreads < 1) {
         fprintf(stderr, "Must at least run in 1 thread!\n");
         return;
     }
 
-    // spawn threads
-    auto threads_arr = new std::thread[m_uNumThreads];
-    auto avg_runtimes_arr = new double[m_uNumThreads];
-    get_timestamp(&t1);
-    get_process_cputime_timestamp(&cpu_usr_t1, &cpu_sys_t1);
-    for (unsigned int i = 0; i < m_uNumThreads; i++) {
-        if (i == m_uNumThreads-1u) {
-            measure_single_thread(this, avg_runtimes_arr+i, i);
-        } else {
-            threads_arr[i] = std::thread(measure_single_thread, this, avg_runtimes_arr+i, i);
-        }
-    }
-    
-    // join threads
-    for (unsigned int i = 0; i < m_uNumThreads-1u; i++) threads_arr[i].join();
-    get_timestamp(&t2);
-    get_process_cputime_timestamp(&cpu_usr_t2, &cpu_sys_t2);
+    // the last thread reaching a barrier takes the timestamps, so the
+    // thread creation is not part of the timed region
+    BenchmarkRun state;
+    state.start_barrier.reset(m_uNumThreads);
+    state.end_barrier.reset(m_uNumThreads);
+    state.cpus = m_oThreadPlacement.get_cpus(m_uNumThreads);
+    state.tids.resize(m_uNumThreads);
+    state.avg_runtimes.resize(m_uNumThreads);
+    state.histograms.resize(m_uLatencySampleInterval == 0 ? 0 : m_uNumThreads);
+    state.on_start = [&]() {
+        TRACE_SPAN("stat snapshot");
+        m_oPerfCounters.open(state.tids);
+        m_oPerfCounters.read(state.tids, &perf_t1);
+        m_oCpuTimeSampler.refresh();
+        m_oCpuTimeSampler.sample(&cpu_t1);
+        m_oTimelineRecorder.start();
+        t1 = Clock::now();
+    };
+    state.on_end = [&]() {
+        t2 = Clock::now();
+        TRACE_SPAN("stat snapshot");
+        m_oCpuTimeSampler.sample(&cpu_t2);
+        m_oPerfCounters.read(state.tids, &perf_t2);
+        m_oTimelineRecorder.stop(&m_oTimeline);
+    };
+    m_aThreadCpus.assign(m_uNumThreads, -1);
+    m_oTimelineRecorder.prepare(m_uNumThreads, m_aStatFilepaths);
+
+    // run on the persistent workers
+    m_oThreadPool.run(state.cpus, [&]( unsigned int thread_num ) { run_worker(this, &state, thread_num); });
 
     // process benchmarks
-    m_dFullDuration = get_time_diff_micro(t1, t2);
-    m_dUsrTime = get_time_diff_micro(cpu_usr_t1, cpu_usr_t2);
-    m_dSysTime = get_time_diff_micro(cpu_sys_t1, cpu_sys_t2);
+    m_dFullDuration = Clock::to_micros(t2-t1);
+    m_oCpuTimeSampler.get_diff(cpu_t1, cpu_t2, &m_dUsrTime, &m_dSysTime);
     m_dFullCpuTime = m_dUsrTime + m_dSysTime;
+    if (m_oCpuTimeSampler.m_bPerThread) m_oCpuTimeSampler.get_thread_diff(cpu_t1, cpu_t2, state.tids, &m_aThreadUsages);
+    if (m_oPerfCounters.m_bEnabled) {
+        m_aPerfCounterNames = m_oPerfCounters.get_live_names();
+        m_aPerfCounts.clear();
+        for (unsigned int e = 0; e < PerfCounters::EVENTS.size(); e++) {
+            if (m_oPerfCounters.is_live(e)) m_aPerfCounts.push_back(perf_t2[e]-perf_t1[e]);
+        }
+    }
+    m_dThreadDurationMean = 0.0;
     m_dThreadDurationMax = std::numeric_limits<double>::min();
     m_dThreadDurationMin = std::numeric_limits<double>::max();
     for (unsigned int i = 0; i < m_uNumThreads; i++) {
-        m_dThreadDurationMean += avg_runtimes_arr[i];
-        if (avg_runtimes_arr[i] > m_dThreadDurationMax) m_dThreadDurationMax = avg_runtimes_arr[i];
-        if (avg_runtimes_arr[i] < m_dThreadDurationMin) m_dThreadDurationMin = avg_runtimes_arr[i];
+        m_dThreadDurationMean += state.avg_runtimes[i];
+        if (state.avg_runtimes[i] > m_dThreadDurationMax) m_dThreadDurationMax = state.avg_runtimes[i];
+        if (state.avg_runtimes[i] < m_dThreadDurationMin) m_dThreadDurationMin = state.avg_runtimes[i];
     }
     m_dThreadDurationMean /= m_uNumThreads;
-    m_dThreadDurationMedian = get_median(avg_runtimes_arr, m_uNumThreads);
+    m_dThreadDurationMedian = get_median(state.avg_runtimes.data(), m_uNumThreads);
+    merge_latency_histograms(state.histograms);
+    m_oTimeline.detect_changepoints();
 
     // done
     m_bWasExecuted = true;
-    delete[] avg_runtimes_arr;
-    delete[] threads_arr;
 
 }
 
-int Benchmark::get_timestamp( struct timespec* p_timestamp ) {
-    return clock_gettime(CLOCK_MONOTONIC, p_timestamp);
-}
-
-int Benchmark::get_process_cputime_timestamp( struct timespec* p_timestamp ) {
-    unsigned long utime = 0, stime = 0;
-    std::string line;
-    std::ifstream file(BENCHMARK_STAT_FILE);
-    for (unsigned int i = 0; std::getline(file, line, ' '); i++) {
-        if (i == 13) {
-            utime = std::stoul(line) * (1000000000/HZ);
-        } else if (i == 14) {
-            stime = std::stoul(line) * (1000000000/HZ);
-            break;
-        }
-    }
-    file.close();
-    p_timestamp->tv_sec = utime / 1000000000u;
-    p_timestamp->tv_sec += stime / 1000000000u;
-    p_timestamp->tv_nsec = utime % 1000000000u;
-    p_timestamp->tv_nsec += stime % 1000000000u;
-    return 0;
-}
-
-int Benchmark::get_process_cputime_timestamp( struct timespec* p_timestamp_usr, struct timespec* p_timestamp_sys ) {
-    unsigned long utime = 0, stime = 0;
-    std::string line;
-    std::ifstream file(BENCHMARK_STAT_FILE);
-    for (unsigned int i = 0; std::getline(file, line, ' '); i++) {
-        if (i == 13) {
-            utime = std::stoul(line) * (1000000000/HZ);
-        } else if (i == 14) {
-            stime = std::stoul(line) * (1000000000/HZ);
-            break;
-        }
+void Benchmark::run_worker( Benchmark* self, BenchmarkRun* state, unsigned int thread_num ) {
+
+    // the pool pinned the worker already
+    {
+        TRACE_SPAN("thread start");
+        if (Tracer::m_bEnabled) Tracer::set_thread_name("worker " + std::to_string(thread_num));
+        self->m_aThreadCpus[thread_num] = sched_getcpu();
+        state->tids[thread_num] = syscall(SYS_gettid);
     }
-    file.close();
-    p_timestamp_usr->tv_sec = utime / 1000000000u;
-    p_timestamp_sys->tv_sec += stime / 1000000000u;
-    p_timestamp_usr->tv_nsec = utime % 1000000000u;
-    p_timestamp_sys->tv_nsec += stime % 1000000000u;
-    return 0;
-}
 
-int Benchmark::get_process_cputime_timestamp( std::vector<unsigned long>* timestamps ) {
-    std::string line;
-    std::ifstream file;
-    unsigned int i;
-    timestamps->resize(m_aStatFilepaths.size());
-
-    // read all stat files
-    for (unsigned int f = 0; f < m_aStatFilepaths.size(); f++) {
-        (*timestamps)[f] = 0;
-        file.open(m_aStatFilepaths[f]);
-        if (!file.good()) {
-            LOG_ERROR("Could not read stat file at \"%s\"!\n", m_aStatFilepaths[f].c_str());
-            continue;
-        }
-        for (i = 0; i < 15 && std::getline(file, line, ' '); i++) {
-            if (i < 13) continue;
-            (*timestamps)[f] += std::stoul(line);
-        }
-        file.close();
+    // early finishers do not wait at the end barrier, otherwise their idle
+    // time would count as CPU time
+    {
+        TRACE_SPAN("barrier wait");
+        state->start_barrier.wait(state->on_start);
+    }
+    {
+        TRACE_SPAN("timed loop");
+        self->measure_single_thread(&state->avg_runtimes[thread_num], thread_num, state->histograms.empty() ? nullptr : &state->histograms[thread_num]);
     }
+    state->end_barrier.arrive(state->on_end);
 
-    return 0;
 }
 
-int Benchmark::get_process_cputime_timestamp( std::vector<unsigned long>* timestamps_usr, std::vector<unsigned long>* timestamps_sys ) {
-    std::string line;
-    std::ifstream file;
-    unsigned int i;
-    timestamps_usr->resize(m_aStatFilepaths.size());
-    timestamps_sys->resize(m_aStatFilepaths.size());
-
-    // read all stat files
-    for (unsigned int f = 0; f < m_aStatFilepaths.size(); f++) {
-        file.open(m_aStatFilepaths[f]);
-        if (!file.good()) {
-            LOG_ERROR("Could not read stat file at \"%s\"!\n", m_aStatFilepaths[f].c_str());
-            continue;
-        }
-        for (i = 0; i < 15 && std::getline(file, line, ' '); i++) {
-            if (i == 13) {
-                (*timestamps_usr)[f] = std::stoul(line);
-            } else if (i == 14) {
-                (*timestamps_sys)[f] = std::stoul(line);
-            } else {
-                continue;
-            }
-        }
-        file.close();
-    }
-
-    return 0;
+int Benchmark::get_timestamp( struct timespec* p_timestamp ) {
+    return Clock::get_timespec(p_timestamp);
 }
 
 double Benchmark::get_time_diff_micro( struct timespec &t1, struct timespec &t2 ) {
     return ((double)(t2.tv_sec-t1.tv_sec))*1e6+((double)(t2.tv_nsec-t1.tv_nsec))/1e3;
 }
 
-double Benchmark::get_time_diff_micro( std::vector<unsigned long> &t1, std::vector<unsigned long> &t2 ) {
-    double d = 0.0;
-    if (t1.size() != t2.size()) {
-        LOG_ERROR("Tried to get the time diff from timestamps of different quantaties!\n");
-        return 0.0;
-    }
-    for (unsigned int i = 0; i < t1.size(); i++) d += (t2[i]-t1[i]) * (1000000/HZ);
-    return d;
-}
-
 double Benchmark::get_median( double values[], unsigned long num_values ) {
     if (num_values == 0) return 0.0;
     std::sort(values, values+num_values);
@@ -227,6 +201,7 @@ bool Benchmark::get_stat_files( const char* filepath ) {
             if (s.st_mode & S_IFDIR) {
                 DIR *d = opendir(filepath);
                 if (d == nullptr) return false;
+                m_aStatFilepaths.clear();
                 while ((de = readdir(d)) != nullptr) {
                     stat_filepath = std::string(filepath) + "/" + de->d_name;
                     if (stat_filepath.find('.') == 0) continue;
@@ -235,11 +210,11 @@ bool Benchmark::get_stat_files( const char* filepath ) {
                     m_aStatFilepaths[m_aStatFilepaths.size()-1] = stat_filepath;
                 }
                 closedir(d);
-                return true;
+                return m_oCpuTimeSampler.open(m_aStatFilepaths);
             } else if (s.st_mode & S_IFREG) {
                 m_aStatFilepaths.resize(1);
                 m_aStatFilepaths[0] = filepath;
-                return true;
+                return m_oCpuTimeSampler.open(m_aStatFilepaths);
             }
         }
 
@@ -285,29 +260,57 @@ void Benchmark::print_to( FILE* file ) {
     fprintf(file, "\n");
 }
 
-void Benchmark::process_environment_variables( unsigned int* num_executions, unsigned int* num_threads, std::string* stat_filepath ) {
+void Benchmark::process_environment_variables( unsigned int* num_executions, unsigned int* num_threads, std::string* stat_filepath, unsigned int* latency_sample_interval, ThreadPlacement* thread_placement ) {
     
     // the amount of threads to use
     if (num_threads != nullptr) *num_threads = get_config("BM_NUM_THREADS", (long)std::thread::hardware_concurrency());
 
-    // the amount of executions of the function
-    if (num_executions != nullptr) *num_executions = get_config("BM_NUM_EXECUTIONS", (long)100000);
+    // the amount of executions of the function per thread, 0 lets the batch calibrate it
+    if (num_executions != nullptr) *num_executions = get_config("BM_NUM_EXECUTIONS", (long)0);
 
     // the stat file(s)
     if (stat_filepath != nullptr) *stat_filepath = get_config("BM_STAT_FILES");
+
+    // every n-th call gets recorded in the latency histogram
+    if (latency_sample_interval != nullptr) *latency_sample_interval = get_config("BM_LATENCY_SAMPLE_INTERVAL", (long)0);
+
+    // how to place the threads on the CPUs
+    ThreadPlacement::process_environment_variables(thread_placement);
+
+    // the clock to use for all timings
+    Clock::process_environment_variables();
+
+    // record the CPU time and context switches of every thread
+    m_oCpuTimeSampler.m_bPerThread = get_config("BM_THREAD_ACCOUNTING", (long)0) != 0;
+
+    // count hardware and software events of the benchmark threads
+    m_oPerfCounters.m_bEnabled = get_config("BM_PERF_COUNTERS", (long)0) != 0;
+
+    // the interval of the timeline samples in microseconds
+    m_oTimelineRecorder.m_uIntervalMicroseconds = get_config("BM_TIMELINE_INTERVAL", (long)0);
+
+    // record span events and write them as Chrome trace
+    Tracer::process_environment_variables();
+
+    // stream the results into a binary result file
+    ResultWriter::process_environment_variables();
     
 }
 
-void Benchmark::measure_single_thread( Benchmark* self, double* mean_duration, unsigned int thread_num ) {
-    struct timespec t1, t2;
-
-    // do actual benchmark
-    get_timestamp(&t1);
-    for (unsigned int i = 0; i < self->m_uNumExecutions; i++) self->m_pFunction(self, thread_num);
-    get_timestamp(&t2);
+void Benchmark::measure_single_thread( double* mean_duration, unsigned int thread_num, LatencyHistogram* histogram ) {
+    measure_loop(
+        this,
+        thread_num,
+        mean_duration,
+        histogram,
+        [this, thread_num]() { m_pFunction(this, thread_num); },
+        [this, thread_num]( unsigned int count ) { for (unsigned int i = 0; i < count; i++) m_pFunction(this, thread_num); }
+    );
+}
 
-    // store result
-    *mean_duration = get_time_diff_micro(t1, t2) / self->m_uNumExecutions;
+void Benchmark::merge_latency_histograms( std::vector<LatencyHistogram> &histograms ) {
+    m_oLatencyHistogram.reset();
+    for (auto &h : histograms) m_oLatencyHistogram.merge(h);
 }
 
 void Benchmark::to_json( FILE* file, const char* additional_data ) {
@@ -342,54 +345,153 @@ FrequencyBenchmark::FrequencyBenchmark() {
 void FrequencyBenchmark::run() {
     
     if (m_dTargetFrequency < 1) throw new std::runtime_error("The frequency must be at least one!");
+    if (m_bOpenLoop) {
+        run_open_loop();
+        return;
+    }
 
-    struct timespec t1, t2, t_tmp;
-    std::vector<unsigned long> cpu_usr_t1, cpu_usr_t2, cpu_sys_t1, cpu_sys_t2;
-    double running_since_micros = 0;
+    uint64_t t1, t2;
+    CpuTimeSnapshot cpu_t1, cpu_t2;
     const unsigned int TARGET_EXECUTIONS = ceil(m_dTargetFrequency);
     const double TARGET_RUNTIME = 1e6;
     m_uNumExecutions = 0;
-
-    // run for 1 second or until we reached the desired target executions
-    get_process_cputime_timestamp(&cpu_usr_t1, &cpu_sys_t1);
-    get_timestamp(&t1);
+    m_oPacingErrors.reset();
+    m_oPacer.prepare();
+    m_oTimelineRecorder.prepare(1, m_aStatFilepaths);
+    std::atomic<uint64_t>* ops = m_oTimelineRecorder.get_counter(0);
+
+    // run for 1 second or until we reached the desired target executions. The
+    // i-th call is due at i/frequency, so a late wake-up does not shift the later calls
+    m_oCpuTimeSampler.refresh();
+    m_oCpuTimeSampler.sample(&cpu_t1);
+    m_oTimelineRecorder.start();
+    t1 = Clock::now();
     while (m_uNumExecutions != TARGET_EXECUTIONS) {
 
         // run benchmark function
         m_pFunction(this, 0);
-        get_timestamp(&t2);
+        t2 = Clock::now();
         m_uNumExecutions++;
+        if (ops != nullptr) ops->store(m_uNumExecutions, std::memory_order_relaxed);
 
-        // calculate sleep time
-        running_since_micros = get_time_diff_micro(t1, t2);
-        const double time_left_micros = TARGET_RUNTIME-running_since_micros;
-        const double executions_left = TARGET_EXECUTIONS-m_uNumExecutions;
-        const unsigned int sleep_for_micros = std::max((int)(time_left_micros/(executions_left+1))-5, 0);
-
-        // sleep if possible
-        if ( running_since_micros >= TARGET_RUNTIME ) break;
-        if (b_useSpinning) {
-            while (!get_timestamp(&t_tmp) && get_time_diff_micro(t2, t_tmp) < sleep_for_micros) __asm__ __volatile__( "pause" : : : "memory" );
-        } else {
-            std::this_thread::sleep_for(std::chrono::microseconds(sleep_for_micros));
-        }
+        // wait for the next call
+        if (Clock::to_micros(t2-t1) >= TARGET_RUNTIME || m_uNumExecutions == TARGET_EXECUTIONS) break;
+        TRACE_SPAN("pacing");
+        m_oPacer.wait_until(t1 + Clock::from_micros(m_uNumExecutions * TARGET_RUNTIME / m_dTargetFrequency), &m_oPacingErrors);
 
     }
-    get_timestamp(&t2);
-    get_process_cputime_timestamp(&cpu_usr_t2, &cpu_sys_t2);
+    t2 = Clock::now();
+    m_oCpuTimeSampler.sample(&cpu_t2);
+    m_oTimelineRecorder.stop(&m_oTimeline);
 
     // store result
-    double mean_duration = get_time_diff_micro(t1, t2) / m_uNumExecutions;
+    double mean_duration = Clock::to_micros(t2-t1) / m_uNumExecutions;
 
     // process benchmarks
-    m_dFullDuration = get_time_diff_micro(t1, t2);
-    m_dUsrTime = get_time_diff_micro(cpu_usr_t1, cpu_usr_t2);
-    m_dSysTime = get_time_diff_micro(cpu_sys_t1, cpu_sys_t2);
+    m_dFullDuration = Clock::to_micros(t2-t1);
+    m_oCpuTimeSampler.get_diff(cpu_t1, cpu_t2, &m_dUsrTime, &m_dSysTime);
     m_dFullCpuTime = m_dUsrTime + m_dSysTime;
     m_dThreadDurationMax = mean_duration;
     m_dThreadDurationMin = mean_duration;
     m_dThreadDurationMean = mean_duration;
     m_dThreadDurationMedian = mean_duration;
+    m_dAchievedFrequency = m_uNumExecutions * 1e6 / std::max(m_dFullDuration, TARGET_RUNTIME);
+    m_oTimeline.detect_changepoints();
+
+    // done
+    m_bWasExecuted = true;
+
+}
+
+void FrequencyBenchmark::run_open_loop() {
+
+    if (m_uNumThreads < 1) throw new std::runtime_error("Must at least run in 1 thread!");
+
+    uint64_t t1, t2;
+    CpuTimeSnapshot cpu_t1, cpu_t2;
+    const double TARGET_RUNTIME = 1e6;
+    m_oArrivals.generate(m_dTargetFrequency, TARGET_RUNTIME);
+    const unsigned long num_arrivals = m_oArrivals.m_aOffsets.size();
+    if (num_arrivals == 0) throw new std::runtime_error("The arrival schedule is empty!");
+
+    // the schedule starts once all threads reached the start barrier
+    BenchmarkRun state;
+    state.start_barrier.reset(m_uNumThreads);
+    state.end_barrier.reset(m_uNumThreads);
+    state.cpus = m_oThreadPlacement.get_cpus(m_uNumThreads);
+    state.avg_runtimes.resize(m_uNumThreads);
+    state.histograms.resize(m_uNumThreads);
+    state.pacing_errors.resize(m_uNumThreads);
+    m_oPacer.prepare();
+    state.on_start = [&]() {
+        TRACE_SPAN("stat snapshot");
+        m_oCpuTimeSampler.refresh();
+        m_oCpuTimeSampler.sample(&cpu_t1);
+        m_oTimelineRecorder.start();
+        t1 = Clock::now();
+    };
+    state.on_end = [&]() {
+        t2 = Clock::now();
+        TRACE_SPAN("stat snapshot");
+        m_oCpuTimeSampler.sample(&cpu_t2);
+        m_oTimelineRecorder.stop(&m_oTimeline);
+    };
+    m_aThreadCpus.assign(m_uNumThreads, -1);
+    m_oTimelineRecorder.prepare(m_uNumThreads, m_aStatFilepaths);
+
+    // every thread executes every m_uNumThreads-th arrival
+    m_oThreadPool.run(state.cpus, [&]( unsigned int thread_num ) {
+        if (Tracer::m_bEnabled) Tracer::set_thread_name("worker " + std::to_string(thread_num));
+        m_aThreadCpus[thread_num] = sched_getcpu();
+        state.start_barrier.wait(state.on_start);
+
+        std::atomic<uint64_t>* ops = m_oTimelineRecorder.get_counter(thread_num);
+        LatencyHistogram &histogram = state.histograms[thread_num];
+        double service_time = 0.0;
+        uint64_t count = 0;
+        for (unsigned long i = thread_num; i < num_arrivals; i += m_uNumThreads) {
+
+            // wait for the scheduled start, a late call starts right away
+            const uint64_t scheduled = t1 + m_oArrivals.m_aOffsets[i];
+            {
+                TRACE_SPAN("pacing");
+                m_oPacer.wait_until(scheduled, &state.pacing_errors[thread_num]);
+            }
+
+            // run benchmark function
+            const uint64_t s1 = Clock::now();
+            m_pFunction(this, thread_num);
+            const uint64_t s2 = Clock::now();
+            histogram.record(Clock::to_nanos(s2-scheduled));
+            service_time += Clock::to_micros(s2-s1);
+            count++;
+            if (ops != nullptr) ops->store(count, std::memory_order_relaxed);
+
+        }
+        state.avg_runtimes[thread_num] = count == 0 ? 0.0 : service_time / count;
+        state.end_barrier.arrive(state.on_end);
+    });
+
+    // process benchmarks, the runtimes are the service times without the wait for earlier calls
+    m_uNumExecutions = num_arrivals;
+    m_dFullDuration = Clock::to_micros(t2-t1);
+    m_oCpuTimeSampler.get_diff(cpu_t1, cpu_t2, &m_dUsrTime, &m_dSysTime);
+    m_dFullCpuTime = m_dUsrTime + m_dSysTime;
+    m_dThreadDurationMean = 0.0;
+    m_dThreadDurationMax = std::numeric_limits<double>::min();
+    m_dThreadDurationMin = std::numeric_limits<double>::max();
+    for (unsigned int i = 0; i < m_uNumThreads; i++) {
+        m_dThreadDurationMean += state.avg_runtimes[i];
+        if (state.avg_runtimes[i] > m_dThreadDurationMax) m_dThreadDurationMax = state.avg_runtimes[i];
+        if (state.avg_runtimes[i] < m_dThreadDurationMin) m_dThreadDurationMin = state.avg_runtimes[i];
+    }
+    m_dThreadDurationMean /= m_uNumThreads;
+    m_dThreadDurationMedian = get_median(state.avg_runtimes.data(), m_uNumThreads);
+    merge_latency_histograms(state.histograms);
+    m_oPacingErrors.reset();
+    for (auto &h : state.pacing_errors) m_oPacingErrors.merge(h);
+    m_dAchievedFrequency = num_arrivals * 1e6 / std::max(m_dFullDuration, TARGET_RUNTIME);
+    m_oTimeline.detect_changepoints();
 
     // done
     m_bWasExecuted = true;
@@ -414,6 +516,22 @@ void FrequencyBenchmark::to_json( FILE* file, const char* additional_data ) {
     fprintf(file, "    \"runtimeMin\": %.17g,\n", m_dThreadDurationMin);
     fprintf(file, "    \"runtimeMax\": %.17g,\n", m_dThreadDurationMax);
     fprintf(file, "    \"runtimeMedian\": %.17g,\n", m_dThreadDurationMedian);
+    if (!m_oTimeline.m_aTimes.empty()) {
+        fprintf(file, "    \"timeline\": ");
+        m_oTimeline.to_json(file);
+        fprintf(file, ",\n");
+    }
+    if (m_bOpenLoop) {
+        fprintf(file, "    \"latencyHistogramMicroseconds\": ");
+        m_oLatencyHistogram.to_json(file);
+        fprintf(file, ",\n");
+    }
+    if (m_oPacingErrors.m_uNumSamples != 0) {
+        fprintf(file, "    \"pacingErrorMicroseconds\": ");
+        m_oPacingErrors.to_json(file);
+        fprintf(file, ",\n");
+    }
+    fprintf(file, "    \"achievedFrequency\": %.17g,\n", m_dAchievedFrequency);
     fprintf(file, "    \"targetFrequency\": %.17g\n", m_dTargetFrequency);
     fprintf(file, "}\n");
 }
@@ -423,106 +541,22 @@ void FrequencyBenchmark::to_json( FILE* file, const char* additional_data ) {
 
 
 
-void SleepBenchmark::run() {
-    
-    if (m_dTargetFrequency < 1) throw new std::runtime_error("The frequency must be at least one!");
-
-    struct timespec t1, t2;
-    std::vector<unsigned long> cpu_usr_t1, cpu_usr_t2, cpu_sys_t1, cpu_sys_t2;
-    const unsigned int TARGET_EXECUTIONS = ceil(m_dTargetFrequency);
-    const double TARGET_RUNTIME = 1e6;
-    const unsigned int SLEEP_TIME = (TARGET_RUNTIME/(TARGET_EXECUTIONS-1))-5;
-    m_uNumExecutions = 0;
-
-    // run for 1 second or until we reached the desired target executions
-    get_process_cputime_timestamp(&cpu_usr_t1, &cpu_sys_t1);
-    get_timestamp(&t1);
-    while (m_uNumExecutions != TARGET_EXECUTIONS) {
-
-        // run benchmark function
-        m_pFunction(this, 0);
-        m_uNumExecutions++;
-        if (m_uNumExecutions < TARGET_EXECUTIONS-1) usleep(SLEEP_TIME);
-
-    }
-    get_timestamp(&t2);
-    get_process_cputime_timestamp(&cpu_usr_t2, &cpu_sys_t2);
-
-    // store result
-    double mean_duration = get_time_diff_micro(t1, t2) / m_uNumExecutions;
-
-    // process benchmarks
-    m_dFullDuration = get_time_diff_micro(t1, t2);
-    m_dUsrTime = get_time_diff_micro(cpu_usr_t1, cpu_usr_t2);
-    m_dSysTime = get_time_diff_micro(cpu_sys_t1, cpu_sys_t2);
-    m_dFullCpuTime = m_dUsrTime + m_dSysTime;
-    m_dThreadDurationMax = mean_duration;
-    m_dThreadDurationMin = mean_duration;
-    m_dThreadDurationMean = mean_duration;
-    m_dThreadDurationMedian = mean_duration;
-
-    // done
-    m_bWasExecuted = true;
-
-}
-
-
-
-
-
-
 void WriteBenchmark::run() {
     
     if (m_uBufferSize < 1) throw new std::runtime_error("The buffer size must be at least one!");
     if (m_uNumThreads < 1) throw new std::runtime_error("Must at least run in 1 thread!");
 
-    struct timespec t1, t2;
-    std::vector<unsigned long> cpu_usr_t1, cpu_usr_t2, cpu_sys_t1, cpu_sys_t2;
-    if (m_pBuffer == nullptr) {
-        m_pBuffer = new char[m_uBufferSize];
-
-        // set random data in the buffer just to have something, shouldn't make a difference though
-        for (unsigned int i = 0; i < m_uBufferSize; i++) m_pBuffer[i] = (char)((rand() % (1<<8)) + INT8_MIN);
-    }
-
-    // spawn threads
-    auto threads_arr = new std::thread[m_uNumThreads];
-    auto avg_runtimes_arr = new double[m_uNumThreads];
-    get_timestamp(&t1);
-    get_process_cputime_timestamp(&cpu_usr_t1, &cpu_sys_t1);
-    for (unsigned int i = 0; i < m_uNumThreads; i++) {
-        threads_arr[i] = std::thread(
-            measure_single_thread,
-            this,
-            avg_runtimes_arr+i,
-            i
-        );
-    }
-    
-    // join threads
-    for (unsigned int i = 0; i < m_uNumThreads; i++) threads_arr[i].join();
-    get_timestamp(&t2);
-    get_process_cputime_timestamp(&cpu_usr_t2, &cpu_sys_t2);
+    if (!m_oBuffers.is_allocated()) {
+        if (!m_oBuffers.allocate(m_uNumThreads, m_uBufferSize)) throw new std::runtime_error("Could not allocate the buffers!");
 
-    // process benchmarks
-    m_dFullDuration = get_time_diff_micro(t1, t2);
-    m_dUsrTime = get_time_diff_micro(cpu_usr_t1, cpu_usr_t2);
-    m_dSysTime = get_time_diff_micro(cpu_sys_t1, cpu_sys_t2);
-    m_dFullCpuTime = m_dUsrTime + m_dSysTime;
-    m_dThreadDurationMax = std::numeric_limits<double>::min();
-    m_dThreadDurationMin = std::numeric_limits<double>::max();
-    for (unsigned int i = 0; i < m_uNumThreads; i++) {
-        m_dThreadDurationMean += avg_runtimes_arr[i];
-        if (avg_runtimes_arr[i] > m_dThreadDurationMax) m_dThreadDurationMax = avg_runtimes_arr[i];
-        if (avg_runtimes_arr[i] < m_dThreadDurationMin) m_dThreadDurationMin = avg_runtimes_arr[i];
+        // set random data in the buffers just to have something, shouldn't make a difference though
+        for (unsigned int t = 0; t < m_uNumThreads; t++) {
+            for (unsigned int i = 0; i < m_uBufferSize; i++) m_oBuffers.get(t)[i] = (char)((rand() % (1<<8)) + INT8_MIN);
+        }
     }
-    m_dThreadDurationMean /= m_uNumThreads;
-    m_dThreadDurationMedian = get_median(avg_runtimes_arr, m_uNumThreads);
 
-    // done
-    m_bWasExecuted = true;
-    delete[] avg_runtimes_arr;
-    delete[] threads_arr;
+    // each thread writes into its own file
+    Benchmark::run();
 
 }
 
@@ -547,58 +581,134 @@ void WriteBenchmark::to_json( FILE* file, const char* additional_data ) {
 }
 
 void WriteBenchmark::write_single_thread( WriteBenchmark* self, unsigned int thread_num ) {
-    if (pwrite(self->m_pFileDescriptors[thread_num], self->m_pBuffer, self->m_uBufferSize, 0) == -1) {
+    if (pwrite(self->m_pFileDescriptors[thread_num], self->m_oBuffers.get(thread_num), self->m_uBufferSize, 0) == -1) {
         LOG_ERROR("Could not write to file! Error %d: %s\n", errno, strerror(errno));
         return;
     }
 }
 
-void WriteBenchmark::open_tmp_files() {
-    if (m_pFileDescriptors != nullptr || m_pBuffer != nullptr) {
+std::string WriteBenchmark::get_tmp_filepath( unsigned int thread_num ) const {
+    return m_sFileDirectory + "/write-benchmark-" + std::to_string(thread_num) + ".bin";
+}
+
+const char* WriteBenchmark::get_write_mode_name() const {
+    switch (m_eWriteMode) {
+        case WriteMode::DIRECT: return "direct";
+        case WriteMode::DSYNC: return "dsync";
+        case WriteMode::DIRECT_DSYNC: return "direct_dsync";
+        default: return "buffered";
+    }
+}
+
+bool WriteBenchmark::open_tmp_files() {
+    if (m_pFileDescriptors != nullptr || m_oBuffers.is_allocated()) {
         LOG_WARN("Tried to open the temporary files for the write benchmark, but they are already opened!\n");
-        return;
+        return true;
     }
 
     m_pFileDescriptors = new int[m_uNumThreads];
-    m_pBuffer = new char[m_uBufferSize];
+    std::fill(m_pFileDescriptors, m_pFileDescriptors + m_uNumThreads, -1);
+
+    // O_DIRECT transfers whole logical blocks from aligned memory
+    const bool direct = m_eWriteMode == WriteMode::DIRECT || m_eWriteMode == WriteMode::DIRECT_DSYNC;
+    if (direct && (m_uBufferSize % DIRECT_IO_BLOCK_SIZE != 0 || m_oBuffers.m_uAlignment < DIRECT_IO_BLOCK_SIZE)) {
+        LOG_ERROR("O_DIRECT needs a buffer size and an alignment that are multiples of %lu bytes!\n", DIRECT_IO_BLOCK_SIZE);
+        return false;
+    }
+    int flags = O_WRONLY|O_CREAT;
+    if (direct) flags |= O_DIRECT;
+    if (m_eWriteMode == WriteMode::DSYNC || m_eWriteMode == WriteMode::DIRECT_DSYNC) flags |= O_DSYNC;
 
     // open files
     for (unsigned int i = 0; i < m_uNumThreads; i++) {
-        if ((m_pFileDescriptors[i] = open(("/tmp/write-benchmark-" + std::to_string(i) + ".bin").c_str(), O_WRONLY|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO)) == -1) {
+        TRACE_SPAN("open file");
+        if ((m_pFileDescriptors[i] = open(get_tmp_filepath(i).c_str(), flags, S_IRWXU|S_IRWXG|S_IRWXO)) == -1) {
             LOG_ERROR("Could not open file! Error %d: %s\n", errno, strerror(errno));
-            return;
+            if (direct && errno == EINVAL) LOG_ERROR("The file system of %s does not support O_DIRECT, choose another one with BM_WRITE_DIRECTORY!\n", m_sFileDirectory.c_str());
+            return false;
+        }
+    }
+
+    // every thread writes its own buffer
+    if (!m_oBuffers.allocate(m_uNumThreads, m_uBufferSize)) return false;
+
+    // set random data in the buffers just to have something, shouldn't make a difference though
+    if (m_oBuffers.m_bPrefault) {
+        for (unsigned int t = 0; t < m_uNumThreads; t++) {
+            char* buffer = m_oBuffers.get(t);
+            for (unsigned int i = 0; i < m_uBufferSize; i++) buffer[i] = (char)((rand() % (1<<8)) + INT8_MIN);
         }
     }
 
-    // set random data in the buffer just to have something, shouldn't make a difference though
-    for (unsigned int i = 0; i < m_uBufferSize; i++) m_pBuffer[i] = (char)((rand() % (1<<8)) + INT8_MIN);
+    // a vectored write carries the buffer of the thread several times
+    if (m_oIoBatching.m_uVectors > 1) {
+        m_pIoVectors = new struct iovec[m_uNumThreads * m_oIoBatching.m_uVectors];
+        for (unsigned int i = 0; i < m_uNumThreads * m_oIoBatching.m_uVectors; i++) m_pIoVectors[i] = { m_oBuffers.get(i / m_oIoBatching.m_uVectors), m_uBufferSize };
+    }
+
+    // a coalesced write copies the buffer several times into the staging buffer of the thread
+    if (m_oIoBatching.m_uCoalesce > 1) {
+        m_oStagingBuffers.m_eBacking = m_oBuffers.m_eBacking;
+        m_oStagingBuffers.m_uAlignment = m_oBuffers.m_uAlignment;
+        m_oStagingBuffers.m_bPrefault = m_oBuffers.m_bPrefault;
+        if (!m_oStagingBuffers.allocate(m_uNumThreads, m_uBufferSize * m_oIoBatching.m_uCoalesce)) return false;
+    }
+    return true;
 }
 
 void WriteBenchmark::close_tmp_files() {
-    delete[] m_pBuffer;
-    m_pBuffer = nullptr;
+    m_oBuffers.free();
+    m_oStagingBuffers.free();
+    delete[] m_pIoVectors;
+    m_pIoVectors = nullptr;
     if (m_pFileDescriptors == nullptr) {
         LOG_WARN("Tried to close the temporary files for the write benchmark, but they are already closed!\n");
         return;
     }
     for (unsigned int i = 0; i < m_uNumThreads; i++) {
+        if (m_pFileDescriptors[i] == -1) continue;
+        TRACE_SPAN("close file");
         close(m_pFileDescriptors[i]);
-        unlink(("/tmp/write-benchmark-" + std::to_string(i) + ".bin").c_str());
-        while (access(("/tmp/write-benchmark-" + std::to_string(i) + ".bin").c_str(), F_OK) == 0) usleep(1000);
+        unlink(get_tmp_filepath(i).c_str());
+        while (access(get_tmp_filepath(i).c_str(), F_OK) == 0) usleep(1000);
     }
     delete[] m_pFileDescriptors;
     m_pFileDescriptors = nullptr;
 }
 
-void WriteBenchmark::process_environment_variables( unsigned int* num_executions, unsigned int* num_threads, size_t* buffer_size ) {
+void WriteBenchmark::process_environment_variables( unsigned int* num_executions, unsigned int* num_threads, size_t* buffer_size, WriteMode* write_mode, std::string* file_directory ) {
 
     Benchmark::process_environment_variables(num_executions, num_threads);
 
     // the buffer size to use for the write benchmark
     if (buffer_size != nullptr) *buffer_size = get_config("BM_BUFFER_SIZE", (size_t)4096);
+
+    // buffered, direct (O_DIRECT), dsync (O_DSYNC) or direct_dsync (both)
+    if (write_mode != nullptr) {
+        const auto mode = get_config("BM_WRITE_MODE", std::string("buffered"));
+        *write_mode = mode == "direct" ? WriteMode::DIRECT : mode == "dsync" ? WriteMode::DSYNC : mode == "direct_dsync" ? WriteMode::DIRECT_DSYNC : WriteMode::BUFFERED;
+    }
+
+    // the directory of the temporary files
+    if (file_directory != nullptr) *file_directory = get_config("BM_WRITE_DIRECTORY", std::string("/tmp"));
     
 }
 
+void FrequencyBenchmark::process_environment_variables( unsigned int* num_executions, unsigned int* num_threads, size_t* buffer_size, bool* open_loop, ArrivalSchedule* arrivals, Pacer* pacer ) {
+
+    WriteBenchmark::process_environment_variables(num_executions, num_threads, buffer_size);
+
+    // closed waits for every call before scheduling the next one, open starts the calls at precomputed times
+    if (open_loop != nullptr) *open_loop = get_config("BM_LOAD_MODE", std::string("closed")) == "open";
+
+    // how the arrivals of the open-loop mode are distributed
+    ArrivalSchedule::process_environment_variables(arrivals);
+
+    // how to wait for the scheduled start of the calls
+    Pacer::process_environment_variables(pacer);
+
+}
+
 
 
 
@@ -612,19 +722,38 @@ void Batch::run( Benchmark &benchmark ) {
     if (m_uNumBatches < 1) throw new std::runtime_error("Must at least run one batch!");
     m_pBenchmarks = new Benchmark[m_uNumBatches];
 
+    // find the executions per batch, then measure the overhead of the harness with them
+    {
+        TRACE_SPAN("calibration");
+        calibrate_executions(benchmark);
+        m_oCalibration.run(benchmark);
+    }
+
+    // start measuring once the runtime is steady
+    {
+        TRACE_SPAN("warmup");
+        m_oWarmup.run(benchmark);
+    }
+    open_result_file(benchmark);
+
     // run benchmarks
-    benchmark.run(); // run benchmark once as warmup phase
-    for (unsigned int i = 0; i < m_uNumBatches; i++) {
+    const uint64_t start = Clock::now();
+    m_uNumExecutedBatches = 0;
+    while (m_uNumExecutedBatches < m_uNumBatches) {
+        TRACE_SPAN("batch");
         benchmark.run();
-        m_pBenchmarks[i] = benchmark;
+        m_pBenchmarks[m_uNumExecutedBatches] = benchmark;
+        write_result_columns(m_uNumExecutedBatches++);
+        if (is_done(start)) break;
     }
+    ThreadScaling::record(*this);
 
     // done
     m_bWasExecuted = true;
 }
 
 void Batch::to_json( FILE* file, const char* additional_data ) {
-    if (m_pBenchmarks == nullptr || m_uNumBatches == 0 || !m_bWasExecuted) {
+    if (m_pBenchmarks == nullptr || m_uNumExecutedBatches == 0 || !m_bWasExecuted) {
         LOG_WARN("Cannot write benchmark results to file!\n");
         return;
     }
@@ -632,21 +761,103 @@ void Batch::to_json( FILE* file, const char* additional_data ) {
     fprintf(file, "{\n");
     if (additional_data != nullptr) fprintf(file, "    %s,\n", additional_data);
     fprintf(file, "    \"runtimesMicroseconds\": [");
-        for (unsigned int i = 0; i < m_uNumBatches; i++) fprintf(file, "%.17g%s", m_pBenchmarks[i].m_dThreadDurationMean, i==m_uNumBatches-1 ? "" : ", ");
+        for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) fprintf(file, "%.17g%s", m_pBenchmarks[i].m_dThreadDurationMean, i==m_uNumExecutedBatches-1 ? "" : ", ");
         fprintf(file, "],\n");
+    if (m_oCalibration.was_executed()) {
+        fprintf(file, "    \"correctedRuntimesMicroseconds\": [");
+            for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) fprintf(file, "%.17g%s", m_oCalibration.correct(m_pBenchmarks[i].m_dThreadDurationMean), i==m_uNumExecutedBatches-1 ? "" : ", ");
+            fprintf(file, "],\n");
+        fprintf(file, "    \"harnessOverheadMicroseconds\": ");
+            m_oCalibration.to_json(file);
+            fprintf(file, ",\n");
+    }
     fprintf(file, "    \"cpuTimesMicroseconds\": [");
-        for (unsigned int i = 0; i < m_uNumBatches; i++) fprintf(file, "%.17g%s", m_pBenchmarks[i].m_dFullCpuTime/m_pBenchmarks[0].m_uNumExecutions, i==m_uNumBatches-1 ? "" : ", ");
+        for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) fprintf(file, "%.17g%s", m_pBenchmarks[i].m_dFullCpuTime/m_pBenchmarks[0].m_uNumExecutions, i==m_uNumExecutedBatches-1 ? "" : ", ");
         fprintf(file, "],\n");
     fprintf(file, "    \"sysCpuTimesMicroseconds\": [");
-        for (unsigned int i = 0; i < m_uNumBatches; i++) fprintf(file, "%.17g%s", m_pBenchmarks[i].m_dSysTime/m_pBenchmarks[0].m_uNumExecutions, i==m_uNumBatches-1 ? "" : ", ");
+        for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) fprintf(file, "%.17g%s", m_pBenchmarks[i].m_dSysTime/m_pBenchmarks[0].m_uNumExecutions, i==m_uNumExecutedBatches-1 ? "" : ", ");
         fprintf(file, "],\n");
     fprintf(file, "    \"usrCpuTimesMicroseconds\": [");
-        for (unsigned int i = 0; i < m_uNumBatches; i++) fprintf(file, "%.17g%s", m_pBenchmarks[i].m_dUsrTime/m_pBenchmarks[0].m_uNumExecutions, i==m_uNumBatches-1 ? "" : ", ");
+        for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) fprintf(file, "%.17g%s", m_pBenchmarks[i].m_dUsrTime/m_pBenchmarks[0].m_uNumExecutions, i==m_uNumExecutedBatches-1 ? "" : ", ");
+        fprintf(file, "],\n");
+    if (!m_pBenchmarks[0].m_aPerfCounterNames.empty()) {
+        const auto &names = m_pBenchmarks[0].m_aPerfCounterNames;
+        fprintf(file, "    \"perfCounters\": [");
+            for (unsigned int e = 0; e < names.size(); e++) fprintf(file, "\"%s\"%s", names[e].c_str(), e==names.size()-1 ? "" : ", ");
+            fprintf(file, "],\n");
+        fprintf(file, "    \"perfCountsPerExecution\": {");
+            for (unsigned int e = 0; e < names.size(); e++) {
+                fprintf(file, "\"%s\": [", names[e].c_str());
+                for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) fprintf(file, "%.17g%s", m_pBenchmarks[i].m_aPerfCounts[e]/m_pBenchmarks[0].m_uNumExecutions, i==m_uNumExecutedBatches-1 ? "" : ", ");
+                fprintf(file, "]%s", e==names.size()-1 ? "" : ",\n        ");
+            }
+            fprintf(file, "},\n");
+    }
+    fprintf(file, "    \"clock\": ");
+        Clock::to_json(file);
+        fprintf(file, ",\n");
+    fprintf(file, "    \"threadPlacement\": \"%s\",\n", m_pBenchmarks[0].m_oThreadPlacement.get_policy_name());
+    fprintf(file, "    \"threadCpus\": [");
+        for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) {
+            fprintf(file, "[");
+            for (unsigned int j = 0; j < m_pBenchmarks[i].m_aThreadCpus.size(); j++) fprintf(file, "%d%s", m_pBenchmarks[i].m_aThreadCpus[j], j==m_pBenchmarks[i].m_aThreadCpus.size()-1 ? "" : ", ");
+            fprintf(file, "]%s", i==m_uNumExecutedBatches-1 ? "" : ", ");
+        }
         fprintf(file, "],\n");
+    if (m_pBenchmarks[0].m_uLatencySampleInterval != 0) {
+        fprintf(file, "    \"latencySampleInterval\": %u,\n", m_pBenchmarks[0].m_uLatencySampleInterval);
+        fprintf(file, "    \"latencyHistogramsMicroseconds\": [");
+            for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) {
+                m_pBenchmarks[i].m_oLatencyHistogram.to_json(file);
+                if (i != m_uNumExecutedBatches-1) fprintf(file, ",\n        ");
+            }
+            fprintf(file, "],\n");
+    }
+    if (!m_pBenchmarks[0].m_aThreadUsages.empty()) {
+        fprintf(file, "    \"threadAccounting\": [");
+            for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) {
+                CpuTimeSampler::thread_usages_to_json(file, m_pBenchmarks[i].m_aThreadUsages);
+                if (i != m_uNumExecutedBatches-1) fprintf(file, ",\n        ");
+            }
+            fprintf(file, "],\n");
+    }
+    if (!m_pBenchmarks[0].m_oTimeline.m_aTimes.empty()) {
+        fprintf(file, "    \"timelines\": [");
+            for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) {
+                m_pBenchmarks[i].m_oTimeline.to_json(file);
+                if (i != m_uNumExecutedBatches-1) fprintf(file, ",\n        ");
+            }
+            fprintf(file, "],\n");
+    }
+    fprintf(file, "    \"statistics\": ");
+        m_oStatistics.to_json(file);
+        fprintf(file, ",\n");
+    if (m_oWarmup.was_executed()) {
+        fprintf(file, "    \"warmup\": ");
+            m_oWarmup.to_json(file);
+            fprintf(file, ",\n");
+    }
+    if (!m_aExecutionSteps.empty()) {
+        fprintf(file, "    \"executionCalibration\": ");
+            execution_calibration_to_json(file);
+            fprintf(file, ",\n");
+    }
+    if (m_dTargetPrecision > 0.0) {
+        fprintf(file, "    \"adaptive\": ");
+            adaptive_to_json(file);
+            fprintf(file, ",\n");
+    }
+    fprintf(file, "    \"numBatches\": %u,\n", m_uNumExecutedBatches);
     fprintf(file, "    \"numThreads\": %u,\n", m_pBenchmarks[0].m_uNumThreads);
     fprintf(file, "    \"numExecutions\": %u,\n", m_pBenchmarks[0].m_uNumExecutions);
+    fprintf(file, "    \"config\": %s,\n", Config::to_json().c_str());
+    if (!Config::m_aUnknownKeys.empty()) fprintf(file, "    \"unknownConfigKeys\": %s,\n", Config::unknown_keys_to_json().c_str());
     fprintf(file, "    \"type\": \"TROUGHPUT-BENCHMARK\"");
     fprintf(file, "}\n");
+
+    // the additional data is only known now
+    if (m_oResultWriter.is_open() && additional_data != nullptr) m_oResultWriter.add_json("additionalData", RESULT_RUN_INDEX, std::string("{") + additional_data + "}");
+    m_oResultWriter.close();
 }
 
 void Batch::to_json( const char* path, const char* additional_data ) {
@@ -659,10 +870,129 @@ void Batch::to_json( const char* path, const char* additional_data ) {
     fclose(file);
 }
 
-void Batch::process_environment_variables( unsigned int* num_batches ) {
+void Batch::calibrate_executions( Benchmark &benchmark ) {
+    m_aExecutionSteps.clear();
+    if (benchmark.m_uNumExecutions != 0) return;
+
+    // grow by at least 2x, at most 10x and aim 40% above the target, so the
+    // last step rarely falls short of it
+    double executions = 1;
+    while (true) {
+        benchmark.m_uNumExecutions = executions;
+        benchmark.run();
+        m_aExecutionSteps.push_back(std::make_pair(benchmark.m_uNumExecutions, benchmark.m_dFullDuration));
+        if (benchmark.m_dFullDuration >= m_dMinBatchDuration) break;
+        const double factor = benchmark.m_dFullDuration <= 0.0 ? 10.0 : 1.4 * m_dMinBatchDuration / benchmark.m_dFullDuration;
+        executions = ceil(executions * std::min(std::max(factor, 2.0), 10.0));
+        if (executions > (double)std::numeric_limits<int>::max()) {
+            LOG_WARN("Could not reach a batch duration of %.0fus with %u executions!\n", m_dMinBatchDuration, benchmark.m_uNumExecutions);
+            break;
+        }
+    }
+    LOG_INFO("Calibrated %u executions per batch (%.0fus)\n", benchmark.m_uNumExecutions, benchmark.m_dFullDuration);
+}
+
+void Batch::execution_calibration_to_json( FILE* file ) const {
+    fprintf(file, "{\"minBatchDurationMicroseconds\": %.17g, ", m_dMinBatchDuration);
+    fprintf(file, "\"steps\": [");
+    for (unsigned int i = 0; i < m_aExecutionSteps.size(); i++) fprintf(file, "[%u, %.17g]%s", m_aExecutionSteps[i].first, m_aExecutionSteps[i].second, i==m_aExecutionSteps.size()-1 ? "" : ", ");
+    fprintf(file, "]}");
+}
+
+bool Batch::is_done( uint64_t start ) {
+    const bool is_adaptive = m_dTargetPrecision > 0.0;
+    const bool is_last = m_uNumExecutedBatches >= m_uNumBatches;
+    if (!is_adaptive && !is_last) return false;
+
+    std::vector<double> runtimes;
+    for (unsigned int i = 0; i < m_uNumExecutedBatches; i++) runtimes.push_back(m_pBenchmarks[i].m_dThreadDurationMean);
+    m_oStatistics.compute(runtimes);
+    if (is_last) m_pStopReason = is_adaptive ? "maxBatches" : "fixed";
+    else if (m_uNumExecutedBatches < std::max(m_uMinBatches, 2u)) return false;
+    else if (m_oStatistics.get_relative_half_width() <= m_dTargetPrecision) m_pStopReason = "precision";
+    else if (m_dMaxDuration > 0.0 && Clock::to_micros(Clock::now()-start) >= m_dMaxDuration*1e6) m_pStopReason = "maxDuration";
+    else return false;
+
+    if (is_adaptive) LOG_INFO("Stopped after %u batches (%s) with a precision of %.3f%%\n", m_uNumExecutedBatches, m_pStopReason, m_oStatistics.get_relative_half_width()*100.0);
+    if (m_oResultWriter.is_open()) {
+        m_oResultWriter.add_json("statistics", RESULT_RUN_INDEX, [&](FILE* file) { m_oStatistics.to_json(file); });
+        if (is_adaptive) m_oResultWriter.add_json("adaptive", RESULT_RUN_INDEX, [&](FILE* file) { adaptive_to_json(file); });
+        m_oResultWriter.add("numBatches", RESULT_RUN_INDEX, (int64_t)m_uNumExecutedBatches);
+        m_oResultWriter.flush();
+    }
+    return true;
+}
+
+void Batch::adaptive_to_json( FILE* file ) const {
+    fprintf(file, "{\"targetPrecision\": %.17g, ", m_dTargetPrecision);
+    fprintf(file, "\"minBatches\": %u, ", m_uMinBatches);
+    fprintf(file, "\"maxBatches\": %u, ", m_uNumBatches);
+    fprintf(file, "\"maxDurationSeconds\": %.17g, ", m_dMaxDuration);
+    fprintf(file, "\"stopReason\": \"%s\"}", m_pStopReason);
+}
+
+void Batch::open_result_file( const Benchmark &benchmark ) {
+    if (!m_oResultWriter.open("TROUGHPUT-BENCHMARK")) return;
+    m_oResultWriter.add_json("clock", RESULT_RUN_INDEX, [](FILE* file) { Clock::to_json(file); });
+    m_oResultWriter.add_string("threadPlacement", RESULT_RUN_INDEX, benchmark.m_oThreadPlacement.get_policy_name());
+    if (benchmark.m_uLatencySampleInterval != 0) m_oResultWriter.add("latencySampleInterval", RESULT_RUN_INDEX, (int64_t)benchmark.m_uLatencySampleInterval);
+    m_oResultWriter.add("numThreads", RESULT_RUN_INDEX, (int64_t)benchmark.m_uNumThreads);
+    m_oResultWriter.add("numExecutions", RESULT_RUN_INDEX, (int64_t)benchmark.m_uNumExecutions);
+    if (m_oCalibration.was_executed()) m_oResultWriter.add_json("harnessOverheadMicroseconds", RESULT_RUN_INDEX, [&](FILE* file) { m_oCalibration.to_json(file); });
+    if (m_oWarmup.was_executed()) m_oResultWriter.add_json("warmup", RESULT_RUN_INDEX, [&](FILE* file) { m_oWarmup.to_json(file); });
+    if (!m_aExecutionSteps.empty()) m_oResultWriter.add_json("executionCalibration", RESULT_RUN_INDEX, [&](FILE* file) { execution_calibration_to_json(file); });
+    m_oResultWriter.flush();
+}
+
+void Batch::write_result_columns( unsigned int batch ) {
+    if (!m_oResultWriter.is_open()) return;
+    const Benchmark &benchmark = m_pBenchmarks[batch];
+    const double num_executions = m_pBenchmarks[0].m_uNumExecutions;
+    m_oResultWriter.add("runtimesMicroseconds", batch, benchmark.m_dThreadDurationMean);
+    if (m_oCalibration.was_executed()) m_oResultWriter.add("correctedRuntimesMicroseconds", batch, m_oCalibration.correct(benchmark.m_dThreadDurationMean));
+    m_oResultWriter.add("cpuTimesMicroseconds", batch, benchmark.m_dFullCpuTime/num_executions);
+    m_oResultWriter.add("sysCpuTimesMicroseconds", batch, benchmark.m_dSysTime/num_executions);
+    m_oResultWriter.add("usrCpuTimesMicroseconds", batch, benchmark.m_dUsrTime/num_executions);
+    if (!benchmark.m_aPerfCounterNames.empty()) {
+        std::string names;
+        for (unsigned int e = 0; e < benchmark.m_aPerfCounterNames.size(); e++) names += (e == 0 ? "" : ", ") + to_json_string(benchmark.m_aPerfCounterNames[e]);
+        if (batch == 0) m_oResultWriter.add_json("perfCounters", RESULT_RUN_INDEX, "[" + names + "]");
+        for (unsigned int e = 0; e < benchmark.m_aPerfCounterNames.size(); e++) m_oResultWriter.add(("perfCountsPerExecution." + benchmark.m_aPerfCounterNames[e]).c_str(), batch, benchmark.m_aPerfCounts[e]/num_executions);
+    }
+    m_oResultWriter.add("threadCpus", batch, std::vector<int64_t>(benchmark.m_aThreadCpus.begin(), benchmark.m_aThreadCpus.end()));
+    if (benchmark.m_uLatencySampleInterval != 0) m_oResultWriter.add_json("latencyHistogramsMicroseconds", batch, [&](FILE* file) { benchmark.m_oLatencyHistogram.to_json(file); });
+    if (!benchmark.m_aThreadUsages.empty()) m_oResultWriter.add_json("threadAccounting", batch, [&](FILE* file) { CpuTimeSampler::thread_usages_to_json(file, benchmark.m_aThreadUsages); });
+    if (!benchmark.m_oTimeline.m_aTimes.empty()) {
+        m_oResultWriter.add("timelines[].timesMicroseconds", batch, benchmark.m_oTimeline.m_aTimes);
+        m_oResultWriter.add("timelines[].throughputs", batch, benchmark.m_oTimeline.m_aThroughputs);
+        m_oResultWriter.add("timelines[].cpuUtilizations", batch, benchmark.m_oTimeline.m_aCpuUtilizations);
+        m_oResultWriter.add_json("timelines[].changepoints", batch, [&](FILE* file) { benchmark.m_oTimeline.changepoints_to_json(file); });
+    }
+    m_oResultWriter.flush();
+}
+
+void Batch::process_environment_variables( unsigned int* num_batches, unsigned int* num_calibration_runs, double* target_precision, unsigned int* min_batches, double* max_duration, double* min_batch_duration, SteadyStateWarmup* warmup ) {
     
     // the amount of executions of the whole benchmark
     if (num_batches != nullptr) *num_batches = get_config("BM_NUM_BATCHES", (long)100);
+
+    // the amount of runs of the empty function to measure the harness overhead
+    if (num_calibration_runs != nullptr) *num_calibration_runs = get_config("BM_NUM_CALIBRATION_RUNS", (long)10);
+
+    // the relative half-width of the confidence interval to stop at
+    if (target_precision != nullptr) *target_precision = get_config("BM_TARGET_PRECISION", (double)0.0);
+
+    // the minimum amount of batches in adaptive mode
+    if (min_batches != nullptr) *min_batches = get_config("BM_MIN_BATCHES", (long)5);
+
+    // the wall-clock budget in seconds in adaptive mode
+    if (max_duration != nullptr) *max_duration = get_config("BM_MAX_DURATION", (double)0.0);
+
+    // the minimum time of a batch in milliseconds to calibrate the executions to
+    if (min_batch_duration != nullptr) *min_batch_duration = get_config("BM_MIN_BATCH_DURATION", (double)50.0) * 1e3;
+
+    // the steady state test and the budget of the warmup
+    SteadyStateWarmup::process_environment_variables(warmup);
     
 }
 
@@ -679,23 +1009,111 @@ bool FrequencyBatch::was_executed() {
 void FrequencyBatch::run( FrequencyBenchmark &benchmark ) {
     if (m_pBenchmarks != nullptr) delete[] m_pBenchmarks;
     if (m_uNumSamples < 2) throw new std::runtime_error("Must at least run two samples!");
+    if (m_eSpacing != FrequencySpacing::LINEAR && m_dMinFrequency <= 0) throw new std::runtime_error("The minimum frequency must be positive for logarithmic steps!");
     m_pBenchmarks = new FrequencyBenchmark[m_uNumSamples];
+    m_uNumExecutedSamples = 0;
+    m_iLastSustainedSample = m_iFirstSaturatedSample = -1;
+    if (m_oResultWriter.open("FREQUENCY-BENCHMARK")) {
+        m_oResultWriter.add_json("clock", RESULT_RUN_INDEX, [](FILE* file) { Clock::to_json(file); });
+        m_oResultWriter.add("numThreads", RESULT_RUN_INDEX, (int64_t)benchmark.m_uNumThreads);
+        m_oResultWriter.add_string("loadMode", RESULT_RUN_INDEX, benchmark.m_bOpenLoop ? "open" : "closed");
+        if (benchmark.m_bOpenLoop) m_oResultWriter.add_string("arrivalProcess", RESULT_RUN_INDEX, benchmark.m_oArrivals.get_process_name());
+        m_oResultWriter.add_string("frequencySpacing", RESULT_RUN_INDEX, get_spacing_name());
+        m_oResultWriter.flush();
+    }
 
-    // run benchmarks
-    const double step_size = (m_dMaxFrequency-m_dMinFrequency) / (m_uNumSamples-1);
-    for (unsigned int i = 0; i < m_uNumSamples; i++) {
-        m_pBenchmarks[i] = benchmark;
-        m_pBenchmarks[i].m_dTargetFrequency = m_dMinFrequency + i*step_size;
-        LOG_INFO("Running sample %u of %u at frequency %.2f...\n", i+1, m_uNumSamples, m_pBenchmarks[i].m_dTargetFrequency);
-        m_pBenchmarks[i].run();
+    if (m_eSpacing == FrequencySpacing::SEARCH) {
+
+        // the saturation frequency lies between the sustained and the saturated sample, the
+        // bracket gets halved in log space until it is narrow enough or the samples run out
+        if (run_sample(benchmark, m_dMinFrequency)) {
+            m_iFirstSaturatedSample = 0;
+        } else if (!run_sample(benchmark, m_dMaxFrequency)) {
+            m_iLastSustainedSample = 1;
+        } else {
+            m_iLastSustainedSample = 0;
+            m_iFirstSaturatedSample = 1;
+            while (m_uNumExecutedSamples < m_uNumSamples) {
+                const double sustained = m_pBenchmarks[m_iLastSustainedSample].m_dTargetFrequency;
+                const double saturated = m_pBenchmarks[m_iFirstSaturatedSample].m_dTargetFrequency;
+                if (saturated <= sustained * (1.0+m_dSaturationTolerance)) break;
+                const int sample = m_uNumExecutedSamples;
+                if (run_sample(benchmark, sqrt(sustained*saturated))) m_iFirstSaturatedSample = sample;
+                else m_iLastSustainedSample = sample;
+            }
+        }
+
+    } else {
+
+        // the samples run in ascending order, the first saturated one ends the sustained range
+        const double step_size = (m_dMaxFrequency-m_dMinFrequency) / (m_uNumSamples-1);
+        const double step_ratio = m_eSpacing == FrequencySpacing::LOGARITHMIC ? pow(m_dMaxFrequency/m_dMinFrequency, 1.0/(m_uNumSamples-1)) : 1.0;
+        for (unsigned int i = 0; i < m_uNumSamples; i++) {
+            const double frequency = m_eSpacing == FrequencySpacing::LOGARITHMIC ? m_dMinFrequency*pow(step_ratio, i) : m_dMinFrequency + i*step_size;
+            const bool saturated = run_sample(benchmark, frequency);
+            if (saturated && m_iFirstSaturatedSample == -1) m_iFirstSaturatedSample = i;
+            if (!saturated && m_iFirstSaturatedSample == -1) m_iLastSustainedSample = i;
+        }
+
+    }
+    if (m_iLastSustainedSample == -1) {
+        LOG_WARN("The benchmark did not keep up with any frequency!\n");
+    } else if (m_iFirstSaturatedSample == -1) {
+        LOG_INFO("The benchmark kept up with all frequencies up to %.2f\n", m_pBenchmarks[m_iLastSustainedSample].m_dTargetFrequency);
+    } else {
+        LOG_INFO("The benchmark saturates between %.2f and %.2f\n", m_pBenchmarks[m_iLastSustainedSample].m_dTargetFrequency, m_pBenchmarks[m_iFirstSaturatedSample].m_dTargetFrequency);
+    }
+    if (m_oResultWriter.is_open()) {
+        m_oResultWriter.add_json("saturation", RESULT_RUN_INDEX, [&](FILE* file) { saturation_to_json(file); });
+        m_oResultWriter.add_json("pacing", RESULT_RUN_INDEX, [&](FILE* file) { benchmark.m_oPacer.to_json(file); });
+        m_oResultWriter.flush();
     }
 
     // done
     m_bWasExecuted = true;
 }
 
+bool FrequencyBatch::run_sample( FrequencyBenchmark &benchmark, double frequency ) {
+    const unsigned int i = m_uNumExecutedSamples;
+    benchmark.m_dTargetFrequency = frequency;
+    LOG_INFO("Running sample %u of %s%u at frequency %.2f...\n", i+1, m_eSpacing == FrequencySpacing::SEARCH ? "at most " : "", m_uNumSamples, frequency);
+    TRACE_SPAN("sample");
+
+    // run the given benchmark itself, a copy would lose the run() of derived classes
+    benchmark.run();
+    m_pBenchmarks[i] = benchmark;
+    m_uNumExecutedSamples++;
+    if (benchmark.m_bOpenLoop) LOG_INFO("Achieved %.2f of %.2f calls/s, p99 latency %.2fus\n", benchmark.m_dAchievedFrequency, frequency, benchmark.m_oLatencyHistogram.get_percentile(99.0));
+    else LOG_INFO("Achieved %.2f of %.2f calls/s\n", benchmark.m_dAchievedFrequency, frequency);
+    write_result_columns(i);
+    return is_saturated(benchmark);
+}
+
+bool FrequencyBatch::is_saturated( const FrequencyBenchmark &benchmark ) const {
+    return benchmark.m_dAchievedFrequency < m_dSaturationThreshold * benchmark.m_dTargetFrequency;
+}
+
+const char* FrequencyBatch::get_spacing_name() const {
+    switch (m_eSpacing) {
+        case FrequencySpacing::LOGARITHMIC: return "log";
+        case FrequencySpacing::SEARCH: return "search";
+        default: return "linear";
+    }
+}
+
+void FrequencyBatch::saturation_to_json( FILE* file ) const {
+    fprintf(file, "{\"threshold\": %.17g, ", m_dSaturationThreshold);
+    if (m_eSpacing == FrequencySpacing::SEARCH) fprintf(file, "\"tolerance\": %.17g, ", m_dSaturationTolerance);
+    if (m_iLastSustainedSample == -1 || m_iFirstSaturatedSample == -1) fprintf(file, "\"frequency\": null, ");
+    else fprintf(file, "\"frequency\": %.17g, ", m_pBenchmarks[m_iLastSustainedSample].m_dTargetFrequency);
+    if (m_iLastSustainedSample == -1) fprintf(file, "\"lastSustainedSample\": null, ");
+    else fprintf(file, "\"lastSustainedSample\": %d, ", m_iLastSustainedSample);
+    if (m_iFirstSaturatedSample == -1) fprintf(file, "\"firstSaturatedSample\": null}");
+    else fprintf(file, "\"firstSaturatedSample\": %d}", m_iFirstSaturatedSample);
+}
+
 void FrequencyBatch::to_json( FILE* file, const char* additional_data ) {
-    if (m_pBenchmarks == nullptr || m_uNumSamples == 0 || !m_bWasExecuted) {
+    if (m_pBenchmarks == nullptr || m_uNumExecutedSamples == 0 || !m_bWasExecuted) {
         LOG_WARN("Cannot write benchmark results to file!\n");
         return;
     }
@@ -703,14 +1121,32 @@ void FrequencyBatch::to_json( FILE* file, const char* additional_data ) {
     fprintf(file, "{\n");
     if (additional_data != nullptr) fprintf(file, "    %s,\n", additional_data);
     fprintf(file, "    \"benchmarks\": [");
-        for (unsigned int i = 0; i < m_uNumSamples; i++) {
+        for (unsigned int i = 0; i < m_uNumExecutedSamples; i++) {
             m_pBenchmarks[i].to_json(file);
-            if (i != m_uNumSamples-1) fputc(',', file);
+            if (i != m_uNumExecutedSamples-1) fputc(',', file);
         }
         fprintf(file, "],\n");
+    fprintf(file, "    \"clock\": ");
+        Clock::to_json(file);
+        fprintf(file, ",\n");
     fprintf(file, "    \"numThreads\": %u,\n", m_pBenchmarks[0].m_uNumThreads);
+    fprintf(file, "    \"loadMode\": \"%s\",\n", m_pBenchmarks[0].m_bOpenLoop ? "open" : "closed");
+    if (m_pBenchmarks[0].m_bOpenLoop) fprintf(file, "    \"arrivalProcess\": \"%s\",\n", m_pBenchmarks[0].m_oArrivals.get_process_name());
+    fprintf(file, "    \"pacing\": ");
+        m_pBenchmarks[0].m_oPacer.to_json(file);
+        fprintf(file, ",\n");
+    fprintf(file, "    \"frequencySpacing\": \"%s\",\n", get_spacing_name());
+    fprintf(file, "    \"saturation\": ");
+        saturation_to_json(file);
+        fprintf(file, ",\n");
+    fprintf(file, "    \"config\": %s,\n", Config::to_json().c_str());
+    if (!Config::m_aUnknownKeys.empty()) fprintf(file, "    \"unknownConfigKeys\": %s,\n", Config::unknown_keys_to_json().c_str());
     fprintf(file, "    \"type\": \"FREQUENCY-BENCHMARK\"");
     fprintf(file, "}\n");
+
+    // the additional data is only known now
+    if (m_oResultWriter.is_open() && additional_data != nullptr) m_oResultWriter.add_json("additionalData", RESULT_RUN_INDEX, std::string("{") + additional_data + "}");
+    m_oResultWriter.close();
 }
 
 void FrequencyBatch::to_json( const char* path, const char* additional_data ) {
@@ -719,7 +1155,28 @@ void FrequencyBatch::to_json( const char* path, const char* additional_data ) {
     fclose(file);
 }
 
-void FrequencyBatch::process_environment_variables( unsigned int* num_samples, double* min_frequency, double* max_frequency ) {
+void FrequencyBatch::write_result_columns( unsigned int sample ) {
+    if (!m_oResultWriter.is_open()) return;
+    const FrequencyBenchmark &benchmark = m_pBenchmarks[sample];
+    m_oResultWriter.add("benchmarks[].numExecutions", sample, (int64_t)benchmark.m_uNumExecutions);
+    m_oResultWriter.add("benchmarks[].numThreads", sample, (int64_t)benchmark.m_uNumThreads);
+    m_oResultWriter.add("benchmarks[].fullDuration", sample, benchmark.m_dFullDuration);
+    m_oResultWriter.add("benchmarks[].fullCpuTime", sample, benchmark.m_dFullCpuTime);
+    m_oResultWriter.add("benchmarks[].sysCpuTime", sample, benchmark.m_dSysTime);
+    m_oResultWriter.add("benchmarks[].usrCpuTime", sample, benchmark.m_dUsrTime);
+    m_oResultWriter.add("benchmarks[].runtimeMean", sample, benchmark.m_dThreadDurationMean);
+    m_oResultWriter.add("benchmarks[].runtimeMin", sample, benchmark.m_dThreadDurationMin);
+    m_oResultWriter.add("benchmarks[].runtimeMax", sample, benchmark.m_dThreadDurationMax);
+    m_oResultWriter.add("benchmarks[].runtimeMedian", sample, benchmark.m_dThreadDurationMedian);
+    if (!benchmark.m_oTimeline.m_aTimes.empty()) m_oResultWriter.add_json("benchmarks[].timeline", sample, [&](FILE* file) { benchmark.m_oTimeline.to_json(file); });
+    if (benchmark.m_bOpenLoop) m_oResultWriter.add_json("benchmarks[].latencyHistogramMicroseconds", sample, [&](FILE* file) { benchmark.m_oLatencyHistogram.to_json(file); });
+    if (benchmark.m_oPacingErrors.m_uNumSamples != 0) m_oResultWriter.add_json("benchmarks[].pacingErrorMicroseconds", sample, [&](FILE* file) { benchmark.m_oPacingErrors.to_json(file); });
+    m_oResultWriter.add("benchmarks[].achievedFrequency", sample, benchmark.m_dAchievedFrequency);
+    m_oResultWriter.add("benchmarks[].targetFrequency", sample, benchmark.m_dTargetFrequency);
+    m_oResultWriter.flush();
+}
+
+void FrequencyBatch::process_environment_variables( unsigned int* num_samples, double* min_frequency, double* max_frequency, FrequencySpacing* spacing, double* saturation_threshold, double* saturation_tolerance ) {
 
     // the amount of samples to do from min to max frequency
     if (num_samples != nullptr) *num_samples = get_config("BM_NUM_SAMPLES", (long)100);
@@ -730,6 +1187,18 @@ void FrequencyBatch::process_environment_variables( unsigned int* num_samples, d
     // the maximum frequency
     if (max_frequency != nullptr) *max_frequency = get_config("BM_MAX_FREQUENCY", (double)1000000);
 
+    // linear or log steps from the minimum to the maximum frequency, or a search for the saturation frequency
+    if (spacing != nullptr) {
+        const auto name = get_config("BM_FREQUENCY_SPACING", std::string("linear"));
+        *spacing = name == "search" ? FrequencySpacing::SEARCH : name == "log" ? FrequencySpacing::LOGARITHMIC : FrequencySpacing::LINEAR;
+    }
+
+    // the fraction of the target frequency a sample has to achieve
+    if (saturation_threshold != nullptr) *saturation_threshold = get_config("BM_SATURATION_THRESHOLD", (double)0.95);
+
+    // the relative width of the bracket around the saturation frequency the search stops at
+    if (saturation_tolerance != nullptr) *saturation_tolerance = get_config("BM_SATURATION_TOLERANCE", (double)0.05);
+
 }
 
 
@@ -739,13 +1208,37 @@ void PeakBatch::run( Benchmark &benchmark ) {
     if (m_uNumBatches < 1) throw new std::runtime_error("Must at least run one batch!");
     m_pBenchmarks = new Benchmark[m_uNumBatches];
 
+    // find the executions per batch, then measure the overhead of the harness with them
+    {
+        TRACE_SPAN("calibration");
+        calibrate_executions(benchmark);
+        m_oCalibration.run(benchmark);
+    }
+
+    // start measuring once the runtime is steady
+    {
+        TRACE_SPAN("warmup");
+        m_oWarmup.run(benchmark);
+    }
+    open_result_file(benchmark);
+
+    m_uSleepTimeMicroseconds = benchmark.m_uNumExecutions*m_uSleepTimePerExecution;
+
     // run benchmarks
-    benchmark.run(); // run benchmark once as warmup phase
-    for (unsigned int i = 0; i < m_uNumBatches; i++) {
-        benchmark.run();
-        m_pBenchmarks[i] = benchmark;
+    const uint64_t start = Clock::now();
+    m_uNumExecutedBatches = 0;
+    while (m_uNumExecutedBatches < m_uNumBatches) {
+        {
+            TRACE_SPAN("batch");
+            benchmark.run();
+            m_pBenchmarks[m_uNumExecutedBatches] = benchmark;
+            write_result_columns(m_uNumExecutedBatches++);
+        }
+        if (is_done(start)) break;
+        TRACE_SPAN("peak pause");
         usleep(m_uSleepTimeMicroseconds);
     }
+    ThreadScaling::record(*this);
 
     // done
     m_bWasExecuted = true;
@@ -6,14 +6,38 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
+
+#include "./clock.h"
+#include "./histogram.h"
+#include "./topology.h"
+#include "./thread-pool.h"
+#include "./calibration.h"
+#include "./cpu-time.h"
+#include "./perf-counters.h"
+#include "./timeline.h"
+#include "./trace.h"
+#include "./result-file.h"
+#include "./statistics.h"
+#include "./warmup.h"
+#include "./registry.h"
+#include "./config.h"
+#include "./sweep.h"
+#include "./scaling.h"
+#include "./arrival.h"
+#include "./pacer.h"
+#include "./io-batching.h"
+#include "./buffer-arena.h"
 
 #define LOG_INFO(x, ...) printf("[INFO]: " x, ##__VA_ARGS__)
 #define LOG_WARN(x, ...) printf("[WARN]: " x, ##__VA_ARGS__)
 #define LOG_ERROR(x, ...) printf("[ERROR]: " x, ##__VA_ARGS__)
-#define CONFIG_DIRECTORY "/tmp/benchmarks_config"
 
 typedef void (*void_func_t)( void* self, unsigned int thread_num );
 
+// the shared state of the worker threads of a single Benchmark::run() call
+struct BenchmarkRun;
+
 class Benchmark {
     
     protected:
@@ -24,25 +48,26 @@ class Benchmark {
         // contains all stat files to read 
         static std::vector<std::string> m_aStatFilepaths;
 
-        /**
-         * @brief Gets a steady clock timestamp
-         * 
-         * @param p_timestamp The timespec struct to store the timestamp in
-         * @return 0 on success
-         */
-        static int get_timestamp( struct timespec* p_timestamp );
+        // samples the CPU time of the stat files
+        static CpuTimeSampler m_oCpuTimeSampler;
+
+        // counts hardware and software events of the benchmark threads
+        static PerfCounters m_oPerfCounters;
+
+        // records the throughput and the CPU utilization over time
+        static TimelineRecorder m_oTimelineRecorder;
+
+        // the workers that execute the benchmark, shared by all benchmarks and kept
+        // alive between the runs
+        static ThreadPool m_oThreadPool;
 
         /**
-         * @brief Gets a timestamp of the CLOCK_PROCESS_CPUTIME_ID clock
+         * @brief Gets a steady clock timestamp from the Clock
          * 
          * @param p_timestamp The timespec struct to store the timestamp in
          * @return 0 on success
          */
-        static int get_process_cputime_timestamp( struct timespec* p_timestamp );
-        static int get_process_cputime_timestamp( std::vector<unsigned long>* timestamps );
-
-        static int get_process_cputime_timestamp( struct timespec* p_timestamp_usr, struct timespec* p_timestamp_sys );
-        static int get_process_cputime_timestamp( std::vector<unsigned long>* timestamps_usr, std::vector<unsigned long>* timestamps_sys );
+        static int get_timestamp( struct timespec* p_timestamp );
 
         /**
          * @brief Returns the time difference in microeconds
@@ -52,7 +77,6 @@ class Benchmark {
          * @return The time difference in microeconds 
          */
         static double get_time_diff_micro( struct timespec &t1, struct timespec &t2 );
-        static double get_time_diff_micro( std::vector<unsigned long> &t1, std::vector<unsigned long> &t2 );
 
         /**
          * @brief Gets the median runtime of the mean time of the given benchmarks
@@ -65,13 +89,76 @@ class Benchmark {
 
         /**
          * @brief Runs the given function several times and returns the average
-         * runtime
+         * runtime. Derived classes can override this to call their function
+         * without the indirection of m_pFunction
          * 
+         * @param mean_duration [OUT]: The average runtime
+         * @param thread_num Tells in which thread this function will be benchmarked
+         * @param histogram [OUT]: The histogram to record every m_uLatencySampleInterval-th
+         * call into. Nothing is recorded if nullptr
+         */
+        virtual void measure_single_thread( double* mean_duration, unsigned int thread_num, LatencyHistogram* histogram = nullptr );
+
+        /**
+         * @brief The timed loop of measure_single_thread(). A template, so the calls
+         * of the benchmarked function can be inlined
+         *
          * @param self A reference to the class instance
+         * @param thread_num The number of the thread, used for the timeline counter
          * @param mean_duration [OUT]: The average runtime
+         * @param histogram [OUT]: The histogram to record every m_uLatencySampleInterval-th
+         * call into. Nothing is recorded if nullptr
+         * @param invoke Calls the benchmarked function once
+         * @param invoke_n Calls the benchmarked function the given amount of times
+         */
+        template<typename Invoke, typename InvokeN>
+        static inline void measure_loop( Benchmark* self, unsigned int thread_num, double* mean_duration, LatencyHistogram* histogram, Invoke invoke, InvokeN invoke_n ) {
+            uint64_t t1, t2, s1;
+            std::atomic<uint64_t>* ops = m_oTimelineRecorder.get_counter(thread_num);
+
+            // do actual benchmark
+            if (histogram == nullptr && ops == nullptr) {
+                t1 = Clock::now();
+                invoke_n(self->m_uNumExecutions);
+                t2 = Clock::now();
+            } else {
+
+                // time every n-th call on its own to keep the timer overhead bounded
+                // and publish the progress for the timeline after every chunk
+                const unsigned int interval = histogram == nullptr ? TIMELINE_CHUNK_SIZE : self->m_uLatencySampleInterval;
+                t1 = Clock::now();
+                for (unsigned int i = 0; i < self->m_uNumExecutions; i += interval) {
+                    const unsigned int count = std::min(interval, self->m_uNumExecutions-i);
+                    if (histogram != nullptr) {
+                        s1 = Clock::now();
+                        invoke();
+                        histogram->record(Clock::to_nanos(Clock::now()-s1));
+                        if (count > 1) invoke_n(count - 1);
+                    } else {
+                        invoke_n(count);
+                    }
+                    if (ops != nullptr) ops->store(i + count, std::memory_order_relaxed);
+                }
+                t2 = Clock::now();
+            }
+
+            // store result
+            *mean_duration = Clock::to_micros(t2-t1) / self->m_uNumExecutions;
+        }
+
+        /**
+         * @brief Waits for all other threads and runs measure_single_thread()
+         *
+         * @param self A reference to the class instance
+         * @param state The shared state of all threads of this run
          * @param thread_num Tells in which thread this function will be benchmarked
          */
-        static void measure_single_thread( Benchmark* self, double* mean_duration, unsigned int thread_num );
+        static void run_worker( Benchmark* self, BenchmarkRun* state, unsigned int thread_num );
+
+        /**
+         * @brief Merges the given per-thread histograms into m_oLatencyHistogram
+         */
+        void merge_latency_histograms( std::vector<LatencyHistogram> &histograms );
 
     public:
 
@@ -108,7 +195,35 @@ class Benchmark {
         // the median execution time of the mean times a function in microseconds
         double m_dThreadDurationMedian = 0.0;
 
+        // every n-th call gets timed individually and recorded in the latency histogram. 0 disables it
+        unsigned int m_uLatencySampleInterval = 0;
+
+        // the latencies of the sampled calls of all threads
+        LatencyHistogram m_oLatencyHistogram;
+
+        // how to distribute the threads on the CPUs
+        ThreadPlacement m_oThreadPlacement;
+
+        // the CPU every thread ran on when the timed region started
+        std::vector<int> m_aThreadCpus;
+
+        // the CPU time and the context switches of every thread of the monitored
+        // processes, only recorded if BM_THREAD_ACCOUNTING is enabled
+        std::vector<ThreadUsage> m_aThreadUsages;
+
+        // the names of the perf counters that could be opened, only recorded if
+        // BM_PERF_COUNTERS is enabled
+        std::vector<std::string> m_aPerfCounterNames;
+
+        // the count of every perf counter in m_aPerfCounterNames summed up over all threads
+        std::vector<double> m_aPerfCounts;
+
+        // the throughput and the CPU utilization over time, only recorded if
+        // BM_TIMELINE_INTERVAL is set
+        TimelineSeries m_oTimeline;
+
         Benchmark( unsigned int num_executions = 100000, unsigned int num_threads = 1 ) : m_uNumExecutions(num_executions), m_uNumThreads(num_threads) {}
+        virtual ~Benchmark() {}
 
         /**
          * @brief Returns true if the benchmark was already
@@ -123,6 +238,21 @@ class Benchmark {
          */
         virtual void run();
 
+        /**
+         * @brief Creates a benchmark that calls an empty function the same
+         * way as this benchmark calls its function. Used to measure the
+         * overhead of the harness
+         *
+         * @return The benchmark, must be deleted by the caller
+         */
+        virtual Benchmark* create_null_benchmark() const;
+
+        /**
+         * @brief Returns the executions for the log, e.g. "1000 times" or
+         * "with calibrated executions" if a Batch calibrates them
+         */
+        std::string get_executions_description() const;
+
         /**
          * @brief Writes the given benchmark as a human readable string
          * 
@@ -142,11 +272,15 @@ class Benchmark {
          * to modify the benchmark
          * 
          * @param num_executions [OUT]: The amount of executions of the function
-         * that shall be benchmarked
+         * that shall be benchmarked. 0 if not configured, a Batch calibrates it then
          * @param num_threads [OUT]: The amount of threads to use for multithreaded
          * benchmarking
+         * @param stat_filepath [OUT]: The stat file or directory of stat files
+         * @param latency_sample_interval [OUT]: Every n-th call gets recorded in the
+         * latency histogram. 0 disables the histogram
+         * @param thread_placement [OUT]: How to distribute the threads on the CPUs
          */
-        static void process_environment_variables( unsigned int* num_executions = nullptr, unsigned int* num_threads = nullptr, std::string* stat_filepath = nullptr );
+        static void process_environment_variables( unsigned int* num_executions = nullptr, unsigned int* num_threads = nullptr, std::string* stat_filepath = nullptr, unsigned int* latency_sample_interval = nullptr, ThreadPlacement* thread_placement = nullptr );
 
         /**
          * @brief Blocks until the file "/tmp/stat" exists
@@ -162,21 +296,60 @@ class Benchmark {
 
 };
 
+template<size_t BufferSize>
+struct WriteKernel;
+
+class IoUringBenchmark;
+
+enum class WriteMode {
+    BUFFERED,       // writes into the page cache
+    DIRECT,         // O_DIRECT, bypasses the page cache
+    DSYNC,          // O_DSYNC, every write waits for the device
+    DIRECT_DSYNC    // O_DIRECT|O_DSYNC
+};
+
 class WriteBenchmark : public Benchmark {
 
+    template<size_t BufferSize>
+    friend struct WriteKernel;
+
+    friend struct VectoredWriteKernel;
+    friend struct CoalescedWriteKernel;
+    friend class IoUringBenchmark;
+
     private:
 
         // contains all file descriptors for the threads
         int* m_pFileDescriptors = nullptr;
 
-        // the string buffer to use for writing into the files
-        char* m_pBuffer = nullptr;
+        // the buffers of the pwritev calls, m_oIoBatching.m_uVectors per thread pointing to its buffer
+        struct iovec* m_pIoVectors = nullptr;
+
+        // the staging buffer of every thread the coalesced writes get copied into
+        BufferArena m_oStagingBuffers;
+
+        /**
+         * @brief Returns the path of the temporary file of the given thread
+         */
+        std::string get_tmp_filepath( unsigned int thread_num ) const;
 
     public:
 
         // the size of the buffer to use for writing in bytes
         size_t m_uBufferSize = 4096;
 
+        // the buffer of every thread, its settings also apply to the staging buffers
+        BufferArena m_oBuffers;
+
+        // the flags the files get opened with
+        WriteMode m_eWriteMode = WriteMode::BUFFERED;
+
+        // the directory of the temporary files, O_DIRECT fails on tmpfs
+        std::string m_sFileDirectory = "/tmp";
+
+        // the buffers written per system call
+        IoBatching m_oIoBatching;
+
         /**
          * @brief Runs the benchmark function with the given buffer size. Each thread
          * uses its own temporary file
@@ -188,13 +361,21 @@ class WriteBenchmark : public Benchmark {
         static void write_single_thread( WriteBenchmark* self, unsigned int thread_num );
 
         /**
-         * @brief Opens the files for the write benchmark and creates the buffer to
-         * use for writing
+         * @brief Returns the name of the write mode as written into the results
+         */
+        const char* get_write_mode_name() const;
+
+        /**
+         * @brief Opens the files for the write benchmark with the flags of the write
+         * mode and allocates the buffer of every thread, plus the vectors or staging
+         * buffers of m_oIoBatching
+         *
+         * @returns false if a file could not be opened or the buffers not be allocated
          */
-        void open_tmp_files();
+        bool open_tmp_files();
 
         /**
-         * @brief Closes all tmp files and frees the buffer
+         * @brief Closes all tmp files and frees the buffers
          */
         void close_tmp_files();
 
@@ -203,17 +384,28 @@ class WriteBenchmark : public Benchmark {
          * to modify the benchmark
          * 
          * @param num_executions [OUT]: The amount of executions of the function
-         * that shall be benchmarked
+         * that shall be benchmarked. 0 if not configured, a Batch calibrates it then
          * @param num_threads [OUT]: The amount of threads to use for multithreaded
          * benchmarking
          * @param buffer_size [OUT]: The buffer size to use for the write benchmark
+         * @param write_mode [OUT]: The flags the files get opened with
+         * @param file_directory [OUT]: The directory of the temporary files
          */
-        static void process_environment_variables( unsigned int* num_executions = nullptr, unsigned int* num_threads = nullptr, size_t* buffer_size = nullptr );
+        static void process_environment_variables( unsigned int* num_executions = nullptr, unsigned int* num_threads = nullptr, size_t* buffer_size = nullptr, WriteMode* write_mode = nullptr, std::string* file_directory = nullptr );
 
 };
 
 class FrequencyBenchmark : public WriteBenchmark { 
 
+    protected:
+
+        /**
+         * @brief Starts the calls at the times of m_oArrivals on m_uNumThreads
+         * threads for one second. The latency of a call is measured from its
+         * scheduled start, so it includes the time it waited for earlier calls
+         */
+        void run_open_loop();
+
     public:
 
         FrequencyBenchmark();
@@ -221,29 +413,55 @@ class FrequencyBenchmark : public WriteBenchmark {
         // the target frequency in Hz. Must be at least two
         double m_dTargetFrequency = 100000;
 
-        bool b_useSpinning = false;
+        // waits for the scheduled start of every call
+        Pacer m_oPacer;
+
+        // how late every call started relative to its schedule, the pacing error
+        LatencyHistogram m_oPacingErrors;
+
+        // false waits for a call to return before the next one is scheduled (closed loop),
+        // true starts the calls at the precomputed times of m_oArrivals (open loop)
+        bool m_bOpenLoop = false;
+
+        // the start times of the calls in open-loop mode
+        ArrivalSchedule m_oArrivals;
+
+        // the executed calls per second of all threads
+        double m_dAchievedFrequency = 0.0;
 
         /**
-         * @brief Runs the benchmark function with the given target frequency. To
-         * achieve this, usleep is used
+         * @brief Runs the benchmark function with the given target frequency for one
+         * second. The calls are scheduled at fixed deadlines that m_oPacer waits for
          */
         void run() override;
 
         void to_json( FILE* file, const char* additional_data = nullptr ) override;
 
+        /**
+         * @brief Checks the environment variables for matching parameters
+         * to modify the benchmark
+         * 
+         * @param num_executions [OUT]: The amount of executions of the function
+         * that shall be benchmarked. 0 if not configured, a Batch calibrates it then
+         * @param num_threads [OUT]: The amount of threads to use for multithreaded
+         * benchmarking, the threads share the arrivals in open-loop mode
+         * @param buffer_size [OUT]: The buffer size to use for the write benchmark
+         * @param open_loop [OUT]: Whether to start the calls at precomputed times
+         * @param arrivals [OUT]: The arrival process of the open-loop mode
+         * @param pacer [OUT]: How to wait for the scheduled start of the calls
+         */
+        static void process_environment_variables( unsigned int* num_executions = nullptr, unsigned int* num_threads = nullptr, size_t* buffer_size = nullptr, bool* open_loop = nullptr, ArrivalSchedule* arrivals = nullptr, Pacer* pacer = nullptr );
+
 };
 
 class SleepBenchmark : public FrequencyBenchmark {
 
     public:
 
-        SleepBenchmark() {};
-
         /**
-         * @brief Runs the benchmark function with the given target frequency. To
-         * achieve this, usleep is used
+         * @brief Sleeps between the calls by default, so the CPU stays idle
          */
-        void run() override;
+        SleepBenchmark() { m_oPacer.m_eMode = PacingMode::SLEEP; }
 
 };
 
@@ -257,14 +475,87 @@ class Batch {
         // the average runtimes of all benchmark executions
         double* m_pMeanRuntimes = nullptr;
 
+        // streams the results of every batch into the result file
+        ResultWriter m_oResultWriter;
+
+        // why the last run stopped: "fixed", "precision", "maxBatches" or "maxDuration"
+        const char* m_pStopReason = "fixed";
+
+        /**
+         * @brief Grows the executions of the benchmark geometrically until a
+         * single run takes at least m_dMinBatchDuration. Does nothing if the
+         * executions are set already
+         */
+        void calibrate_executions( Benchmark &benchmark );
+
+        /**
+         * @brief Writes the steps of the execution calibration as JSON object
+         */
+        void execution_calibration_to_json( FILE* file ) const;
+
+        /**
+         * @brief Updates the statistics of the executed batches and decides
+         * whether to stop. Without a target precision, all m_uNumBatches
+         * batches are executed
+         *
+         * @param start The clock ticks at the start of the first batch
+         */
+        bool is_done( uint64_t start );
+
+        /**
+         * @brief Writes the settings and the outcome of the adaptive mode as JSON object
+         */
+        void adaptive_to_json( FILE* file ) const;
+
+        /**
+         * @brief Creates the result file and writes the columns that describe
+         * the whole run
+         */
+        void open_result_file( const Benchmark &benchmark );
+
+        /**
+         * @brief Appends the columns of the given batch to the result file
+         */
+        void write_result_columns( unsigned int batch );
+
     public:
 
-        // the amount of times to execute benchmark
+        // the amount of times to execute benchmark, the maximum in adaptive mode
         unsigned int m_uNumBatches = 0;
 
+        // the amount of batches executed by the last run
+        unsigned int m_uNumExecutedBatches = 0;
+
+        // stop once the confidence interval of the mean runtime is narrower than
+        // this fraction of the mean (in each direction). 0 disables the adaptive mode
+        double m_dTargetPrecision = 0.0;
+
+        // the amount of batches to execute at least in adaptive mode
+        unsigned int m_uMinBatches = 5;
+
+        // the wall-clock budget of the batches in seconds in adaptive mode, 0 means unlimited
+        double m_dMaxDuration = 0.0;
+
+        // the statistics of the mean runtimes of the executed batches
+        BatchStatistics m_oStatistics;
+
+        // the minimum wall-clock time of a batch in microseconds, the executions
+        // get calibrated to it if the benchmark has none set
+        double m_dMinBatchDuration = 50000.0;
+
+        // the executions and the wall-clock time in microseconds of every
+        // calibration step, empty if the executions were set
+        std::vector<std::pair<unsigned int, double>> m_aExecutionSteps;
+
         // the benchmark results
         Benchmark* m_pBenchmarks = nullptr;
 
+        // the overhead of the harness, measured before the batches
+        HarnessCalibration m_oCalibration;
+
+        // runs probes until the runtime is steady, before the batches
+        SteadyStateWarmup m_oWarmup;
+
         Batch( unsigned int num_batches = 100 ) : m_uNumBatches(num_batches) {}
 
         /**
@@ -297,9 +588,24 @@ class Batch {
          * One batch is one (multithreaded) benchmark that executes the given function
          * for the given number of times. Batches can be used to detect variations
          * in the execution time.
+         * @param num_calibration_runs [OUT]: The amount of runs of an empty function
+         * to measure the overhead of the harness. 0 disables the calibration
+         * @param target_precision [OUT]: The relative half-width of the confidence
+         * interval of the mean runtime to stop at. 0 always runs all batches
+         * @param min_batches [OUT]: The amount of batches to run at least in adaptive mode
+         * @param max_duration [OUT]: The wall-clock budget in seconds in adaptive mode
+         * @param min_batch_duration [OUT]: The minimum wall-clock time of a batch in
+         * microseconds to calibrate the executions to
+         * @param warmup [OUT]: The steady state test and the budget of the warmup
          */
-        static void process_environment_variables( unsigned int* num_batches = nullptr );        
+        static void process_environment_variables( unsigned int* num_batches = nullptr, unsigned int* num_calibration_runs = nullptr, double* target_precision = nullptr, unsigned int* min_batches = nullptr, double* max_duration = nullptr, double* min_batch_duration = nullptr, SteadyStateWarmup* warmup = nullptr );        
+
+};
 
+enum class FrequencySpacing {
+    LINEAR,         // equal steps from the minimum to the maximum frequency
+    LOGARITHMIC,    // equal ratios from the minimum to the maximum frequency
+    SEARCH          // bisects between the minimum and the maximum for the saturation frequency
 };
 
 class FrequencyBatch {
@@ -309,6 +615,37 @@ class FrequencyBatch {
         // gets set to true once run() was executed
         bool m_bWasExecuted = false;
 
+        // streams the results of every sample into the result file
+        ResultWriter m_oResultWriter;
+
+        /**
+         * @brief Runs the benchmark at the given frequency as the next sample
+         *
+         * @returns true if the benchmark did not keep up with the frequency
+         */
+        bool run_sample( FrequencyBenchmark &benchmark, double frequency );
+
+        /**
+         * @brief Returns true if the benchmark achieved less than m_dSaturationThreshold
+         * of its target frequency
+         */
+        bool is_saturated( const FrequencyBenchmark &benchmark ) const;
+
+        /**
+         * @brief Returns the name of m_eSpacing as written into the results
+         */
+        const char* get_spacing_name() const;
+
+        /**
+         * @brief Writes the saturation frequency and the samples around it as JSON object
+         */
+        void saturation_to_json( FILE* file ) const;
+
+        /**
+         * @brief Appends the columns of the given sample to the result file
+         */
+        void write_result_columns( unsigned int sample );
+
     public:
 
         // the lower frequency to execute the benchmark at
@@ -317,10 +654,28 @@ class FrequencyBatch {
         // the lower frequency to execute the benchmark at
         double m_dMaxFrequency = 10000000;
 
-        // the amount of samples to make. Decides the step size of the frequency going from lower to upper
+        // the amount of samples to make. Decides the step size of the frequency going from
+        // lower to upper, the maximum amount of samples of the search
         unsigned int m_uNumSamples = 0;
 
-        // the benchmark results
+        // the amount of samples executed by the last run
+        unsigned int m_uNumExecutedSamples = 0;
+
+        // how the frequencies of the samples are chosen
+        FrequencySpacing m_eSpacing = FrequencySpacing::LINEAR;
+
+        // a sample is saturated if it achieved less than this fraction of its target frequency
+        double m_dSaturationThreshold = 0.95;
+
+        // the search stops once the saturated frequency is at most this fraction above the sustained one
+        double m_dSaturationTolerance = 0.05;
+
+        // the highest sustained sample below the lowest saturated sample and the lowest saturated
+        // sample, -1 if every sample was saturated or none was
+        int m_iLastSustainedSample = -1;
+        int m_iFirstSaturatedSample = -1;
+
+        // the benchmark results, in the order they were executed
         FrequencyBenchmark* m_pBenchmarks = nullptr;
 
         FrequencyBatch( unsigned int num_samples = 100 ) : m_uNumSamples(num_samples) {}
@@ -356,8 +711,13 @@ class FrequencyBatch {
          * benchmark at
          * @param max_frequency [OUT]: The maximum frequency to run the
          * benchmark at
+         * @param spacing [OUT]: How the frequencies of the samples are chosen
+         * @param saturation_threshold [OUT]: The fraction of the target frequency
+         * a sample has to achieve to not be saturated
+         * @param saturation_tolerance [OUT]: The relative width of the bracket
+         * around the saturation frequency the search stops at
          */
-        static void process_environment_variables( unsigned int* num_samples = nullptr, double* min_frequency = nullptr, double* max_frequency = nullptr );
+        static void process_environment_variables( unsigned int* num_samples = nullptr, double* min_frequency = nullptr, double* max_frequency = nullptr, FrequencySpacing* spacing = nullptr, double* saturation_threshold = nullptr, double* saturation_tolerance = nullptr );
 
 };
 
@@ -366,7 +726,10 @@ class PeakBatch : public Batch {
     public:
 
         // the time that is slept between the benchmarks (heavy workloads)
-        unsigned int m_uSleepTimeMicroseconds;
+        unsigned int m_uSleepTimeMicroseconds = 0;
+
+        // the sleep time per execution, sets m_uSleepTimeMicroseconds once the executions are known
+        unsigned int m_uSleepTimePerExecution = 5;
 
         /**
          * @brief Executes the given benchmark several times (as given
@@ -380,46 +743,38 @@ class PeakBatch : public Batch {
 };
 
 static inline std::string get_config( const char* name, const std::string fallback = "" ) {
-    std::string filepath, content;
-    std::ifstream file;
-    
-    // get file path
-    filepath = CONFIG_DIRECTORY "/";
-    filepath += name;
-    LOG_INFO("Opening file \"%s\"...\n", filepath.c_str());
-
-    // read file
-    file.open(filepath.c_str());
-    if (file.is_open() && file.good()) {
-        file >> content;
-        file.close();
-        return content;
-    }
+    std::string value;
+    if (Config::get(name, &value)) return value;
     LOG_WARN("No config found for parameter \"%s\"\n", name);
+    Config::set_default(name, fallback);
     return fallback;
-
 }
 
 static inline double get_config( const char* name, const double fallback ) {
-    const auto s = get_config(name);
-    if (s.empty()) return fallback;
-    return strtod(s.c_str(), nullptr);
+    char s[32];
+    std::string value;
+    if (Config::get(name, &value)) return strtod(value.c_str(), nullptr);
+    snprintf(s, sizeof(s), "%.17g", fallback);
+    Config::set_default(name, s);
+    return fallback;
 }
 
 static inline long get_config( const char* name, const long fallback ) {
-    const auto s = get_config(name);
-    if (s.empty()) return fallback;
-    return strtol(s.c_str(), nullptr, 10);
+    std::string value;
+    if (Config::get(name, &value)) return strtol(value.c_str(), nullptr, 10);
+    Config::set_default(name, std::to_string(fallback));
+    return fallback;
 }
 
 static inline unsigned long get_config( const char* name, const unsigned long fallback ) {
-    const auto s = get_config(name);
-    if (s.empty()) return fallback;
-    return strtoul(s.c_str(), nullptr, 10);
+    std::string value;
+    if (Config::get(name, &value)) return strtoul(value.c_str(), nullptr, 10);
+    Config::set_default(name, std::to_string(fallback));
+    return fallback;
 }
 
 static inline void get_general_config( std::string* data_filepath = nullptr ) {
-    if (data_filepath != nullptr) *data_filepath = get_config("BM_DATA_FILEPATH");
+    if (data_filepath != nullptr) *data_filepath = expand_routine_path(get_config("BM_DATA_FILEPATH"));
 }
 
 /**
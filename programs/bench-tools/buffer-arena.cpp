@@ -0,0 +1,116 @@
+#include "./buffer-arena.h"
+#include "./benchmark.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// the size of a huge page, the mappings with huge pages get rounded up to it
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+bool BufferArena::allocate( unsigned int num_buffers, size_t buffer_size ) {
+    if (is_allocated()) {
+        LOG_WARN("Tried to allocate the buffer arena, but it is already allocated!\n");
+        return true;
+    }
+
+    m_uStride = (buffer_size + m_uAlignment - 1) / m_uAlignment * m_uAlignment;
+    const size_t size = std::max(m_uStride * num_buffers, m_uAlignment);
+    m_eUsedBacking = m_eBacking;
+
+    // huge pages need a reserved pool, without one use small pages instead
+    if (m_eUsedBacking == BufferBacking::HUGETLB) {
+        m_uAllocationSize = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        m_pAllocation = mmap(nullptr, m_uAllocationSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if (m_pAllocation == MAP_FAILED) {
+            LOG_WARN("Could not map huge pages, using small pages instead! Error %d: %s\n", errno, strerror(errno));
+            m_pAllocation = nullptr;
+            m_eUsedBacking = BufferBacking::MMAP;
+        } else {
+            m_pMemory = (char*)m_pAllocation;
+        }
+    }
+
+    // the transparent huge pages need a mapping aligned to the huge page size
+    if (m_eUsedBacking == BufferBacking::MMAP || m_eUsedBacking == BufferBacking::THP) {
+        const size_t padding = m_eUsedBacking == BufferBacking::THP ? HUGE_PAGE_SIZE : 0;
+        m_uAllocationSize = size + padding;
+        m_pAllocation = mmap(nullptr, m_uAllocationSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (m_pAllocation == MAP_FAILED) {
+            LOG_ERROR("Could not map the buffers! Error %d: %s\n", errno, strerror(errno));
+            m_pAllocation = nullptr;
+            return false;
+        }
+        m_pMemory = (char*)m_pAllocation;
+        if (m_eUsedBacking == BufferBacking::THP) {
+            m_pMemory = (char*)(((uintptr_t)m_pAllocation + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+            if (madvise(m_pMemory, size, MADV_HUGEPAGE) != 0) {
+                LOG_WARN("Could not enable transparent huge pages! Error %d: %s\n", errno, strerror(errno));
+                m_eUsedBacking = BufferBacking::MMAP;
+            }
+        }
+    }
+
+    if (m_eUsedBacking == BufferBacking::HEAP) {
+        if ((errno = posix_memalign(&m_pAllocation, m_uAlignment, size)) != 0) {
+            LOG_ERROR("Could not allocate the buffers! Error %d: %s\n", errno, strerror(errno));
+            m_pAllocation = nullptr;
+            return false;
+        }
+        m_uAllocationSize = size;
+        m_pMemory = (char*)m_pAllocation;
+    }
+
+    // fault in the pages now instead of in the timed loop
+    if (m_bPrefault) memset(m_pMemory, 0, size);
+    return true;
+}
+
+void BufferArena::free() {
+    if (m_pAllocation == nullptr) return;
+    if (m_eUsedBacking == BufferBacking::HEAP) ::free(m_pAllocation);
+    else munmap(m_pAllocation, m_uAllocationSize);
+    m_pAllocation = nullptr;
+    m_pMemory = nullptr;
+    m_uAllocationSize = 0;
+}
+
+const char* BufferArena::get_backing_name( bool used ) const {
+    switch (used ? m_eUsedBacking : m_eBacking) {
+        case BufferBacking::MMAP: return "mmap";
+        case BufferBacking::HUGETLB: return "hugetlb";
+        case BufferBacking::THP: return "thp";
+        default: return "heap";
+    }
+}
+
+std::string BufferArena::to_json() const {
+    std::string res = "\"bufferArena\": {";
+    res += std::string("\"backing\": \"") + get_backing_name() + "\"";
+    res += std::string(", \"usedBacking\": \"") + get_backing_name(true) + "\"";
+    res += ", \"alignment\": " + std::to_string(m_uAlignment);
+    res += std::string(", \"prefault\": ") + (m_bPrefault ? "true" : "false");
+    res += "}";
+    return res;
+}
+
+void BufferArena::process_environment_variables( BufferArena* arena ) {
+    if (arena == nullptr) return;
+
+    // heap (posix_memalign), mmap, hugetlb (MAP_HUGETLB) or thp (MADV_HUGEPAGE)
+    const auto backing = get_config("BM_BUFFER_BACKING", std::string("heap"));
+    arena->m_eBacking = backing == "mmap" ? BufferBacking::MMAP : backing == "hugetlb" ? BufferBacking::HUGETLB : backing == "thp" ? BufferBacking::THP : BufferBacking::HEAP;
+
+    // the alignment of every buffer, O_DIRECT needs at least the logical block size
+    arena->m_uAlignment = get_config("BM_BUFFER_ALIGNMENT", (size_t)4096);
+    if (arena->m_uAlignment < sizeof(void*) || (arena->m_uAlignment & (arena->m_uAlignment - 1)) != 0) {
+        LOG_WARN("The buffer alignment must be a power of two of at least %lu, using 4096 instead of %lu!\n", sizeof(void*), arena->m_uAlignment);
+        arena->m_uAlignment = 4096;
+    }
+
+    // touch the pages before the timed loop
+    arena->m_bPrefault = get_config("BM_BUFFER_PREFAULT", (long)1) != 0;
+
+}
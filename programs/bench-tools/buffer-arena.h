@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+
+enum class BufferBacking {
+    HEAP,       // posix_memalign
+    MMAP,       // anonymous mapping with small pages
+    HUGETLB,    // anonymous mapping with MAP_HUGETLB, needs reserved huge pages
+    THP         // anonymous mapping advised with MADV_HUGEPAGE (transparent huge pages)
+};
+
+/**
+ * @brief A single allocation that holds an aligned buffer for every thread, so
+ * the threads don't share cache lines or pages and the buffers meet the
+ * alignment O_DIRECT requires. Like the other members of a benchmark it is
+ * copied shallowly, allocate() and free() must be called explicitly
+ */
+class BufferArena {
+
+    private:
+
+        // the mapping or allocation and its size, the buffers start at m_pMemory
+        void* m_pAllocation = nullptr;
+        size_t m_uAllocationSize = 0;
+        char* m_pMemory = nullptr;
+
+        // the distance between two buffers, the buffer size rounded up to the alignment
+        size_t m_uStride = 0;
+
+        // the backing that was used, differs from m_eBacking if huge pages were not available
+        BufferBacking m_eUsedBacking = BufferBacking::HEAP;
+
+    public:
+
+        // how the memory of the buffers is allocated
+        BufferBacking m_eBacking = BufferBacking::HEAP;
+
+        // the alignment of every buffer in bytes, a power of two
+        size_t m_uAlignment = 4096;
+
+        // touches every page after the allocation, so no page fault happens in the timed loop
+        bool m_bPrefault = true;
+
+        /**
+         * @brief Allocates the buffers, falls back to small pages if huge pages are not available
+         *
+         * @param num_buffers The amount of buffers, usually one per thread
+         * @param buffer_size The size of a single buffer in bytes
+         * @returns false if the memory could not be allocated
+         */
+        bool allocate( unsigned int num_buffers, size_t buffer_size );
+
+        /**
+         * @brief Frees the buffers
+         */
+        void free();
+
+        /**
+         * @brief Returns true if allocate() was called and the buffers were not freed since
+         */
+        inline bool is_allocated() const { return m_pMemory != nullptr; }
+
+        /**
+         * @brief Returns the buffer with the given index
+         */
+        inline char* get( unsigned int index ) const { return m_pMemory + index * m_uStride; }
+
+        /**
+         * @brief Returns the name of the backing as written into the results
+         *
+         * @param used Whether to return the used backing instead of the requested one
+         */
+        const char* get_backing_name( bool used = false ) const;
+
+        /**
+         * @brief Returns the settings and the used backing as JSON property "bufferArena"
+         */
+        std::string to_json() const;
+
+        /**
+         * @brief Checks the environment variables for matching parameters
+         *
+         * @param arena [OUT]: The backing, alignment and prefaulting of the buffers
+         */
+        static void process_environment_variables( BufferArena* arena );
+
+};
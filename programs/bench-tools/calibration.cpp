@@ -0,0 +1,61 @@
+#include "./calibration.h"
+#include "./benchmark.h"
+
+bool HarnessCalibration::was_executed() {
+    return m_bWasExecuted;
+}
+
+void HarnessCalibration::run( const Benchmark &benchmark ) {
+    m_aOverheads.clear();
+    m_oLatencyHistogram.reset();
+    m_aClockReadDeltas.clear();
+    m_bWasExecuted = false;
+    if (m_uNumRuns == 0) return;
+
+    // sample consecutive clock reads
+    std::vector<uint64_t> timestamps(m_uNumClockSamples);
+    for (unsigned int i = 0; i < m_uNumClockSamples; i++) timestamps[i] = Clock::now();
+    for (unsigned int i = 1; i < m_uNumClockSamples; i++) m_aClockReadDeltas.push_back(Clock::to_micros(timestamps[i]-timestamps[i-1]));
+
+    // run the empty function with the same parameters
+    Benchmark* null_benchmark = benchmark.create_null_benchmark();
+    null_benchmark->m_uNumExecutions = benchmark.m_uNumExecutions;
+    null_benchmark->m_uNumThreads = benchmark.m_uNumThreads;
+    null_benchmark->m_uLatencySampleInterval = benchmark.m_uLatencySampleInterval;
+    null_benchmark->m_oThreadPlacement = benchmark.m_oThreadPlacement;
+    null_benchmark->run(); // run once as warmup phase
+    for (unsigned int i = 0; i < m_uNumRuns; i++) {
+        null_benchmark->run();
+        m_aOverheads.push_back(null_benchmark->m_dThreadDurationMean);
+        m_oLatencyHistogram.merge(null_benchmark->m_oLatencyHistogram);
+    }
+    delete null_benchmark;
+
+    // median of all runs
+    m_dOverheadMedian = get_median(m_aOverheads);
+    LOG_INFO("Harness overhead is %.2fns per call\n", m_dOverheadMedian*1e3);
+
+    // done
+    m_bWasExecuted = true;
+}
+
+double HarnessCalibration::correct( double runtime ) const {
+    return runtime - m_dOverheadMedian;
+}
+
+void HarnessCalibration::to_json( FILE* file ) {
+    fprintf(file, "{\n");
+    fprintf(file, "        \"runtimesMicroseconds\": [");
+        for (unsigned int i = 0; i < m_aOverheads.size(); i++) fprintf(file, "%.17g%s", m_aOverheads[i], i==m_aOverheads.size()-1 ? "" : ", ");
+        fprintf(file, "],\n");
+    fprintf(file, "        \"runtimeMedian\": %.17g,\n", m_dOverheadMedian);
+    if (m_oLatencyHistogram.m_uNumSamples != 0) {
+        fprintf(file, "        \"latencyHistogramMicroseconds\": ");
+        m_oLatencyHistogram.to_json(file);
+        fprintf(file, ",\n");
+    }
+    fprintf(file, "        \"clockReadDeltasMicroseconds\": [");
+        for (unsigned int i = 0; i < m_aClockReadDeltas.size(); i++) fprintf(file, "%.17g%s", m_aClockReadDeltas[i], i==m_aClockReadDeltas.size()-1 ? "" : ", ");
+        fprintf(file, "]\n");
+    fprintf(file, "    }");
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+
+#include "./histogram.h"
+
+class Benchmark;
+
+/**
+ * @brief Measures the overhead of the harness itself (the timed loop, the call
+ * of the benchmarked function and the timer reads) by running an empty function
+ * with the same parameters as the actual benchmark
+ */
+class HarnessCalibration {
+
+    protected:
+
+        // gets set to true once run() was executed
+        bool m_bWasExecuted = false;
+
+    public:
+
+        // the amount of runs of the empty function. 0 disables the calibration
+        unsigned int m_uNumRuns = 10;
+
+        // the amount of consecutive clock reads to sample
+        unsigned int m_uNumClockSamples = 1000;
+
+        // the mean runtime of the empty function of every run in microseconds
+        std::vector<double> m_aOverheads;
+
+        // the median of m_aOverheads in microseconds
+        double m_dOverheadMedian = 0.0;
+
+        // the latencies of the sampled calls of the empty function of all runs
+        LatencyHistogram m_oLatencyHistogram;
+
+        // the time between two consecutive clock reads in microseconds
+        std::vector<double> m_aClockReadDeltas;
+
+        /**
+         * @brief Returns true if the calibration was already executed
+         */
+        bool was_executed();
+
+        /**
+         * @brief Runs the empty function with the same amount of threads,
+         * executions and placement as the given benchmark
+         *
+         * @param benchmark The benchmark to measure the harness overhead for
+         */
+        void run( const Benchmark &benchmark );
+
+        /**
+         * @brief Returns the given runtime minus the median harness overhead
+         *
+         * @param runtime The mean runtime of a call in microseconds
+         */
+        double correct( double runtime ) const;
+
+        /**
+         * @brief Writes the calibration result as JSON object
+         *
+         * @param file The file to write the calibration into
+         */
+        void to_json( FILE* file );
+
+};
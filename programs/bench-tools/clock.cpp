@@ -0,0 +1,122 @@
+#include "./clock.h"
+#include "./benchmark.h"
+
+#include <cpuid.h>
+
+#define CALIBRATION_TIME_NANOSECONDS 20000000ull
+#define NUM_OVERHEAD_SAMPLES 10000
+
+ClockSource Clock::m_eSource = ClockSource::MONOTONIC;
+double Clock::m_dNanosPerTick = 1.0;
+uint64_t Clock::m_uTscBase = 0;
+uint64_t Clock::m_uMonotonicBase = 0;
+double Clock::m_dResolution = 0.0;
+double Clock::m_dOverhead = 0.0;
+
+static inline uint64_t get_monotonic_nanos() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec*1000000000ull + t.tv_nsec;
+}
+
+bool Clock::is_tsc_invariant() {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) return false;
+    __cpuid(0x80000007, eax, ebx, ecx, edx);
+    return (edx & (1u << 8)) != 0;
+}
+
+void Clock::calibrate_tsc() {
+    uint64_t m1, m2, t1, t2;
+
+    // take the middle of two monotonic reads as the time of the TSC read
+    m1 = get_monotonic_nanos();
+    t1 = read_tsc();
+    m1 = (m1 + get_monotonic_nanos()) / 2;
+
+    // busy wait, sleeping could change the CPU frequency
+    while (get_monotonic_nanos() - m1 < CALIBRATION_TIME_NANOSECONDS) __asm__ __volatile__( "pause" : : : "memory" );
+    m2 = get_monotonic_nanos();
+    t2 = read_tsc();
+    m2 = (m2 + get_monotonic_nanos()) / 2;
+
+    m_dNanosPerTick = (double)(m2-m1) / (t2-t1);
+    m_uTscBase = t2;
+    m_uMonotonicBase = m2;
+}
+
+void Clock::measure_source() {
+    uint64_t first, last, prev, t;
+    double resolution = 1e18;
+
+    first = prev = now();
+    for (unsigned int i = 0; i < NUM_OVERHEAD_SAMPLES; i++) {
+        t = now();
+        if (t != prev && to_nanos(t-prev) < resolution) resolution = to_nanos(t-prev);
+        prev = t;
+    }
+    last = now();
+
+    m_dOverhead = to_nanos(last-first) / (NUM_OVERHEAD_SAMPLES+1);
+    m_dResolution = resolution;
+}
+
+int Clock::get_timespec( struct timespec* p_timestamp ) {
+    if (m_eSource != ClockSource::TSC) return clock_gettime(CLOCK_MONOTONIC, p_timestamp);
+    const uint64_t nanos = m_uMonotonicBase + (int64_t)(((int64_t)(read_tsc()-m_uTscBase)) * m_dNanosPerTick);
+    p_timestamp->tv_sec = nanos / 1000000000u;
+    p_timestamp->tv_nsec = nanos % 1000000000u;
+    return 0;
+}
+
+void Clock::init( ClockSource preferred, bool prefer_cheapest ) {
+    double monotonic_overhead;
+
+    // clock_gettime is always available
+    m_eSource = ClockSource::MONOTONIC;
+    measure_source();
+    if (preferred == ClockSource::MONOTONIC) return;
+    if (!is_tsc_invariant()) {
+        LOG_WARN("The TSC is not invariant, using CLOCK_MONOTONIC!\n");
+        return;
+    }
+
+    // switch to the TSC if it is cheaper
+    monotonic_overhead = m_dOverhead;
+    calibrate_tsc();
+    m_eSource = ClockSource::TSC;
+    measure_source();
+    if (prefer_cheapest && m_dOverhead >= monotonic_overhead) {
+        m_eSource = ClockSource::MONOTONIC;
+        measure_source();
+    }
+}
+
+const char* Clock::get_source_name() {
+    return m_eSource == ClockSource::TSC ? "tsc" : "monotonic";
+}
+
+void Clock::to_json( FILE* file ) {
+    fprintf(file, "{\"source\": \"%s\", ", get_source_name());
+    fprintf(file, "\"frequency\": %.17g, ", m_eSource == ClockSource::TSC ? 1e9 / m_dNanosPerTick : 1e9);
+    fprintf(file, "\"resolutionNanoseconds\": %.17g, ", m_dResolution);
+    fprintf(file, "\"overheadNanoseconds\": %.17g}", m_dOverhead);
+}
+
+void Clock::process_environment_variables() {
+    static bool initialized = false;
+    if (initialized) return;
+    initialized = true;
+
+    // the clock source
+    const auto source = get_config("BM_CLOCK_SOURCE", std::string("auto"));
+    if (source == "monotonic") {
+        init(ClockSource::MONOTONIC);
+    } else if (source == "tsc") {
+        init(ClockSource::TSC);
+    } else {
+        if (source != "auto") LOG_WARN("Unknown clock source \"%s\"! Using the cheapest one\n", source.c_str());
+        init(ClockSource::TSC, true);
+    }
+    LOG_INFO("Using %s as clock source (%.2fns overhead, %.2fns resolution)\n", get_source_name(), m_dOverhead, m_dResolution);
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+// BM_CLOCK_SOURCE selects one of both, the default "auto" picks the cheaper one
+enum class ClockSource {
+    MONOTONIC,  // clock_gettime(CLOCK_MONOTONIC), used by "auto" if the TSC is not invariant or not cheaper
+    TSC         // rdtsc calibrated against CLOCK_MONOTONIC, requires an invariant TSC
+};
+
+/**
+ * @brief The clock used for all timings of the harness. Ticks are nanoseconds
+ * for CLOCK_MONOTONIC and TSC cycles for the TSC. Some enclave runtimes turn
+ * clock_gettime into an OCALL, which is more expensive than the system calls we
+ * measure, thus the TSC can be used instead
+ */
+class Clock {
+
+    private:
+
+        // the nanoseconds per TSC cycle
+        static double m_dNanosPerTick;
+
+        // the TSC value at the calibration
+        static uint64_t m_uTscBase;
+
+        // the CLOCK_MONOTONIC time in nanoseconds at the calibration
+        static uint64_t m_uMonotonicBase;
+
+        /**
+         * @brief Reads the TSC. The fences prevent that the read is reordered
+         * with the surrounding instructions
+         */
+        static inline uint64_t read_tsc() {
+            uint32_t lo, hi;
+            __asm__ __volatile__( "lfence\n\trdtsc\n\tlfence" : "=a"(lo), "=d"(hi) : : "memory" );
+            return ((uint64_t)hi << 32) | lo;
+        }
+
+        /**
+         * @brief Measures the TSC frequency against CLOCK_MONOTONIC
+         */
+        static void calibrate_tsc();
+
+        /**
+         * @brief Measures the resolution and the overhead of the current source
+         */
+        static void measure_source();
+
+    public:
+
+        // the source of now()
+        static ClockSource m_eSource;
+
+        // the smallest observed difference of two consecutive reads in nanoseconds
+        static double m_dResolution;
+
+        // the mean duration of a single read in nanoseconds
+        static double m_dOverhead;
+
+        /**
+         * @brief Returns the current time in ticks of the current source
+         */
+        static inline uint64_t now() {
+            if (m_eSource == ClockSource::TSC) return read_tsc();
+            struct timespec t;
+            clock_gettime(CLOCK_MONOTONIC, &t);
+            return t.tv_sec*1000000000ull + t.tv_nsec;
+        }
+
+        /**
+         * @brief Converts a duration in ticks to nanoseconds
+         */
+        static inline double to_nanos( uint64_t ticks ) {
+            return m_eSource == ClockSource::TSC ? ticks * m_dNanosPerTick : (double)ticks;
+        }
+
+        /**
+         * @brief Converts a duration in ticks to microseconds
+         */
+        static inline double to_micros( uint64_t ticks ) {
+            return to_nanos(ticks) / 1e3;
+        }
+
+        /**
+         * @brief Converts a duration in microseconds to ticks
+         */
+        static inline uint64_t from_micros( double micros ) {
+            return m_eSource == ClockSource::TSC ? (uint64_t)(micros * 1e3 / m_dNanosPerTick) : (uint64_t)(micros * 1e3);
+        }
+
+        /**
+         * @brief Returns the current time as CLOCK_MONOTONIC timestamp
+         *
+         * @param p_timestamp The timespec struct to store the timestamp in
+         * @return 0 on success
+         */
+        static int get_timespec( struct timespec* p_timestamp );
+
+        /**
+         * @brief Returns true if the CPU reports an invariant TSC
+         */
+        static bool is_tsc_invariant();
+
+        /**
+         * @brief Selects and calibrates the clock source
+         *
+         * @param preferred MONOTONIC forces clock_gettime. TSC uses the TSC if
+         * it is invariant
+         * @param prefer_cheapest If true, the TSC is only used if it is cheaper
+         * to read than clock_gettime
+         */
+        static void init( ClockSource preferred, bool prefer_cheapest = false );
+
+        /**
+         * @brief Returns the name of the current source
+         */
+        static const char* get_source_name();
+
+        /**
+         * @brief Writes the clock source, its resolution and overhead as JSON object
+         *
+         * @param file The file to write the clock information into
+         */
+        static void to_json( FILE* file );
+
+        /**
+         * @brief Checks the environment variables for the clock source and
+         * initializes the clock. BM_CLOCK_SOURCE can be "monotonic", "tsc"
+         * or "auto" (the default) that uses the cheaper one of both. Only the
+         * first call initializes the clock
+         */
+        static void process_environment_variables();
+
+};
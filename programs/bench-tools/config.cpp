@@ -0,0 +1,255 @@
+#include "./config.h"
+#include "./benchmark.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+
+extern char** environ;
+
+std::map<std::string, ConfigValue> Config::m_oValues;
+bool Config::m_bLoaded = false;
+std::map<std::string, std::pair<bool, ConfigValue>> Config::m_oOverridden;
+std::string Config::m_sFilepath;
+std::vector<std::string> Config::m_aUnknownKeys;
+
+// all keys read by the harness and the routines
+static const ConfigSchemaEntry SCHEMA[] = {
+    {"BM_ARRIVAL_PROCESS", ConfigType::STRING, "constant|poisson"},
+    {"BM_ARRIVAL_SEED", ConfigType::INT, nullptr},
+    {"BM_BUFFER_ALIGNMENT", ConfigType::INT, nullptr},
+    {"BM_BUFFER_BACKING", ConfigType::STRING, "heap|mmap|hugetlb|thp"},
+    {"BM_BUFFER_PREFAULT", ConfigType::INT, "0|1"},
+    {"BM_BUFFER_SIZE", ConfigType::INT, nullptr},
+    {"BM_CLOCK_SOURCE", ConfigType::STRING, "auto|tsc|monotonic"},
+    {"BM_CPU_LIST", ConfigType::STRING, nullptr},
+    {"BM_DATA_FILEPATH", ConfigType::STRING, nullptr},
+    {"BM_FREQUENCY_SPACING", ConfigType::STRING, "linear|log|search"},
+    {"BM_IOURING_BATCH", ConfigType::INT, nullptr},
+    {"BM_IOURING_QUEUE_DEPTH", ConfigType::INT, nullptr},
+    {"BM_IOURING_REGISTER_BUFFERS", ConfigType::INT, "0|1"},
+    {"BM_IOURING_REGISTER_FILES", ConfigType::INT, "0|1"},
+    {"BM_IOURING_SQPOLL", ConfigType::INT, "0|1"},
+    {"BM_IO_BACKEND", ConfigType::STRING, "sync|io_uring"},
+    {"BM_IO_COALESCE", ConfigType::INT, nullptr},
+    {"BM_IO_VECTORS", ConfigType::INT, nullptr},
+    {"BM_LATENCY_SAMPLE_INTERVAL", ConfigType::INT, nullptr},
+    {"BM_LOAD_MODE", ConfigType::STRING, "closed|open"},
+    {"BM_MAX_DURATION", ConfigType::FLOAT, nullptr},
+    {"BM_MAX_FREQUENCY", ConfigType::FLOAT, nullptr},
+    {"BM_MAX_WARMUP_DURATION", ConfigType::FLOAT, nullptr},
+    {"BM_MAX_WARMUP_PROBES", ConfigType::INT, nullptr},
+    {"BM_MIN_BATCHES", ConfigType::INT, nullptr},
+    {"BM_MIN_BATCH_DURATION", ConfigType::FLOAT, nullptr},
+    {"BM_MIN_FREQUENCY", ConfigType::FLOAT, nullptr},
+    {"BM_NUM_BATCHES", ConfigType::INT, nullptr},
+    {"BM_NUM_CALIBRATION_RUNS", ConfigType::INT, nullptr},
+    {"BM_NUM_EXECUTIONS", ConfigType::INT, nullptr},
+    {"BM_NUM_SAMPLES", ConfigType::INT, nullptr},
+    {"BM_NUM_THREADS", ConfigType::INT, nullptr},
+    {"BM_PACING", ConfigType::STRING, "sleep|spin|hybrid"},
+    {"BM_PACING_SPIN", ConfigType::FLOAT, nullptr},
+    {"BM_PERF_COUNTERS", ConfigType::INT, "0|1"},
+    {"BM_RESULT_FILEPATH", ConfigType::STRING, nullptr},
+    {"BM_ROUTINES", ConfigType::STRING, nullptr},
+    {"BM_SATURATION_THRESHOLD", ConfigType::FLOAT, nullptr},
+    {"BM_SATURATION_TOLERANCE", ConfigType::FLOAT, nullptr},
+    {"BM_SCALING_COLLAPSE", ConfigType::FLOAT, nullptr},
+    {"BM_SCALING_THREADS", ConfigType::STRING, nullptr},
+    {"BM_STAT_FILES", ConfigType::STRING, nullptr},
+    {"BM_SWEEP", ConfigType::STRING, nullptr},
+    {"BM_SWEEP_MODE", ConfigType::STRING, "cartesian|list"},
+    {"BM_TARGET_PRECISION", ConfigType::FLOAT, nullptr},
+    {"BM_THREAD_ACCOUNTING", ConfigType::INT, "0|1"},
+    {"BM_THREAD_PLACEMENT", ConfigType::STRING, "none|compact|scatter|smt|list"},
+    {"BM_TIMELINE_INTERVAL", ConfigType::INT, nullptr},
+    {"BM_TRACE_BUFFER_SIZE", ConfigType::INT, nullptr},
+    {"BM_TRACE_FILEPATH", ConfigType::STRING, nullptr},
+    {"BM_WARMUP_TOLERANCE", ConfigType::FLOAT, nullptr},
+    {"BM_WARMUP_WINDOW", ConfigType::INT, nullptr},
+    {"BM_WRITE_DIRECTORY", ConfigType::STRING, nullptr},
+    {"BM_WRITE_MODE", ConfigType::STRING, "buffered|direct|dsync|direct_dsync"},
+};
+
+static const char* SOURCE_NAMES[] = {"default", "file", "environment", "argument", "sweep"};
+
+/**
+ * @brief Returns the string without leading and trailing whitespace
+ */
+static std::string trim( const std::string &s ) {
+    const size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    return s.substr(begin, s.find_last_not_of(" \t\r\n")-begin+1);
+}
+
+/**
+ * @brief Splits "KEY=VALUE" into its trimmed parts
+ *
+ * @returns false if there is no "="
+ */
+static bool split_assignment( const std::string &s, std::string* name, std::string* value ) {
+    const size_t position = s.find('=');
+    if (position == std::string::npos) return false;
+    *name = trim(s.substr(0, position));
+    *value = trim(s.substr(position+1));
+    return !name->empty();
+}
+
+const ConfigSchemaEntry* Config::find_entry( const std::string &name ) {
+    for (const auto &entry : SCHEMA) {
+        if (name == entry.name) return &entry;
+    }
+    return nullptr;
+}
+
+bool Config::validate( const ConfigSchemaEntry &entry, const std::string &value, ConfigSource source ) {
+    char* end = nullptr;
+    bool valid = true;
+
+    // check the type and the allowed values
+    if (entry.type == ConfigType::INT) {
+        strtoul(value.c_str(), &end, 10);
+        valid = value[0] != '-' && *end == '\0';
+    } else if (entry.type == ConfigType::FLOAT) {
+        strtod(value.c_str(), &end);
+        valid = *end == '\0';
+    }
+    if (valid && entry.choices != nullptr) {
+        const std::string choices = std::string("|") + entry.choices + "|";
+        valid = choices.find("|" + value + "|") != std::string::npos;
+    }
+    if (!valid) {
+        LOG_ERROR("Invalid value \"%s\" for %s from the %s! Expected %s%s%s\n", value.c_str(), entry.name, SOURCE_NAMES[(int)source],
+            entry.type == ConfigType::INT ? "a non-negative integer" : entry.type == ConfigType::FLOAT ? "a number" : "a string",
+            entry.choices != nullptr ? " out of " : "", entry.choices != nullptr ? entry.choices : "");
+    }
+    return valid;
+}
+
+bool Config::set( const std::string &name, const std::string &value, ConfigSource source ) {
+    const ConfigSchemaEntry* entry = find_entry(name);
+    if (entry == nullptr) {
+        if (std::find(m_aUnknownKeys.begin(), m_aUnknownKeys.end(), name) == m_aUnknownKeys.end()) m_aUnknownKeys.push_back(name);
+        return false;
+    }
+
+    // an empty value unsets the key, e.g. BM_NUM_EXECUTIONS= calibrates the executions
+    if (value.empty()) {
+        m_oValues.erase(name);
+        return true;
+    }
+    if (!validate(*entry, value, source)) return false;
+    m_oValues[name] = {value, source, false};
+    return true;
+}
+
+void Config::load( int argc, char **argv ) {
+    std::string name, value, line;
+    if (m_bLoaded) return;
+    m_bLoaded = true;
+
+    // the config file, the path itself can only be set by the environment or the command line
+    const char* filepath = getenv("BM_CONFIG_FILE");
+    m_sFilepath = filepath != nullptr ? filepath : CONFIG_FILEPATH;
+    for (int i = 1; i+1 < argc; i++) {
+        if (strcmp(argv[i], "--config-file") == 0) m_sFilepath = argv[i+1];
+    }
+    std::ifstream file(m_sFilepath.c_str());
+    if (file.is_open()) {
+        LOG_INFO("Reading config from \"%s\"...\n", m_sFilepath.c_str());
+        for (unsigned int number = 1; std::getline(file, line); number++) {
+            line = trim(line);
+            if (line.empty() || line[0] == '#') continue;
+            if (!split_assignment(line, &name, &value)) {
+                LOG_WARN("Ignoring line %u of the config file, expected KEY=VALUE: \"%s\"\n", number, line.c_str());
+                continue;
+            }
+            set(name, value, ConfigSource::FILE);
+        }
+    } else {
+        LOG_WARN("No config file found at \"%s\"\n", m_sFilepath.c_str());
+    }
+
+    // BM_ environment variables
+    for (char **env = environ; env != nullptr && *env != nullptr; env++) {
+        if (strncmp(*env, "BM_", 3) != 0 || strncmp(*env, "BM_CONFIG_FILE=", 15) == 0) continue;
+        if (split_assignment(*env, &name, &value)) set(name, value, ConfigSource::ENVIRONMENT);
+    }
+
+    // --config KEY=VALUE flags
+    for (int i = 1; i+1 < argc; i++) {
+        if (strcmp(argv[i], "--config") != 0) continue;
+        if (split_assignment(argv[++i], &name, &value)) set(name, value, ConfigSource::ARGUMENT);
+        else LOG_WARN("Ignoring \"--config %s\", expected KEY=VALUE\n", argv[i]);
+    }
+
+    for (const auto &key : m_aUnknownKeys) LOG_WARN("Unknown config key \"%s\"\n", key.c_str());
+}
+
+bool Config::get( const char* name, std::string* value ) {
+    load();
+    auto it = m_oValues.find(name);
+    if (it == m_oValues.end()) return false;
+    it->second.used = true;
+    *value = it->second.value;
+    return true;
+}
+
+void Config::set_default( const char* name, const std::string &value ) {
+    if (m_oValues.find(name) == m_oValues.end()) m_oValues[name] = {value, ConfigSource::DEFAULT, true};
+}
+
+bool Config::is_valid( const std::string &name, const std::string &value ) {
+    const ConfigSchemaEntry* entry = find_entry(name);
+    if (entry == nullptr) {
+        LOG_ERROR("Unknown config key \"%s\"!\n", name.c_str());
+        return false;
+    }
+    return value.empty() || validate(*entry, value, ConfigSource::SWEEP);
+}
+
+bool Config::set_override( const std::string &name, const std::string &value ) {
+    load();
+    if (!is_valid(name, value)) return false;
+    if (m_oOverridden.find(name) == m_oOverridden.end()) {
+        const auto it = m_oValues.find(name);
+        m_oOverridden[name] = it == m_oValues.end() ? std::make_pair(false, ConfigValue()) : std::make_pair(true, it->second);
+    }
+    return set(name, value, ConfigSource::SWEEP);
+}
+
+void Config::clear_overrides() {
+    for (const auto &it : m_oOverridden) {
+        if (it.second.first) m_oValues[it.first] = it.second.second;
+        else m_oValues.erase(it.first);
+    }
+    m_oOverridden.clear();
+}
+
+std::string Config::value_to_json( const std::string &name, const std::string &value ) {
+    char number[32];
+    const ConfigSchemaEntry* entry = find_entry(name);
+    if (entry != nullptr && entry->type == ConfigType::INT) return std::to_string(strtoul(value.c_str(), nullptr, 10));
+    if (entry != nullptr && entry->type == ConfigType::FLOAT) {
+        snprintf(number, sizeof(number), "%.17g", strtod(value.c_str(), nullptr));
+        return number;
+    }
+    return to_json_string(value);
+}
+
+std::string Config::to_json() {
+    std::string res = "{";
+    bool first = true;
+    for (const auto &it : m_oValues) {
+        if (!it.second.used) continue;
+        res += (first ? "" : ", ") + to_json_string(it.first) + ": " + value_to_json(it.first, it.second.value);
+        first = false;
+    }
+    return res + "}";
+}
+
+std::string Config::unknown_keys_to_json() {
+    std::string res = "[";
+    for (unsigned int i = 0; i < m_aUnknownKeys.size(); i++) res += (i == 0 ? "" : ", ") + to_json_string(m_aUnknownKeys[i]);
+    return res + "]";
+}
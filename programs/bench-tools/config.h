@@ -0,0 +1,157 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+
+// the key=value file read at startup, BM_CONFIG_FILE or --config-file overrides it
+#define CONFIG_FILEPATH "/tmp/benchmarks_config/benchmarks.conf"
+
+enum class ConfigType {
+    STRING,
+    INT,    // a non-negative integer
+    FLOAT
+};
+
+enum class ConfigSource {
+    DEFAULT,        // the fallback of get_config
+    FILE,           // the config file
+    ENVIRONMENT,    // a BM_ environment variable
+    ARGUMENT,       // a --config KEY=VALUE flag
+    SWEEP           // the current point of a parameter sweep
+};
+
+/**
+ * @brief A known config key
+ */
+struct ConfigSchemaEntry {
+
+    // the name of the key, e.g. "BM_NUM_THREADS"
+    const char* name;
+
+    // the type the value must parse as
+    ConfigType type;
+
+    // the allowed values separated by "|", nullptr allows all values
+    const char* choices;
+
+};
+
+/**
+ * @brief A set config value
+ */
+struct ConfigValue {
+
+    std::string value;
+
+    ConfigSource source;
+
+    // true once get_config read it, only read values are part of the effective config
+    bool used;
+
+};
+
+/**
+ * @brief The config of a run, parsed once at startup. The layers are the
+ * config file, then BM_ environment variables and then --config KEY=VALUE
+ * command line flags, each overriding the previous one. Values are validated
+ * against the schema, invalid values are dropped and unknown keys collected
+ */
+class Config {
+
+    private:
+
+        // all set values by key
+        static std::map<std::string, ConfigValue> m_oValues;
+
+        // gets set to true once load() was executed
+        static bool m_bLoaded;
+
+        // the values replaced by set_override(), false if the key was not set
+        static std::map<std::string, std::pair<bool, ConfigValue>> m_oOverridden;
+
+        /**
+         * @brief Returns the schema entry of the given key, nullptr for unknown keys
+         */
+        static const ConfigSchemaEntry* find_entry( const std::string &name );
+
+        /**
+         * @brief Checks the value against the schema entry and reports invalid values
+         */
+        static bool validate( const ConfigSchemaEntry &entry, const std::string &value, ConfigSource source );
+
+        /**
+         * @brief Validates the value against the schema and sets it if it is valid
+         *
+         * @returns false if the key is unknown or the value is invalid
+         */
+        static bool set( const std::string &name, const std::string &value, ConfigSource source );
+
+    public:
+
+        // the file the config was read from
+        static std::string m_sFilepath;
+
+        // the keys that are not part of the schema
+        static std::vector<std::string> m_aUnknownKeys;
+
+        /**
+         * @brief Parses all layers of the config, only the first call has an effect.
+         * get_config loads the config without command line flags if this was not
+         * called before
+         *
+         * @param argc The amount of command line arguments
+         * @param argv The command line arguments, all but --config KEY=VALUE and
+         * --config-file PATH are ignored
+         */
+        static void load( int argc = 0, char **argv = nullptr );
+
+        /**
+         * @brief Returns the value of the given key and marks it as used
+         *
+         * @param name The key of the value
+         * @param value [OUT]: The value, unchanged if the key is not set
+         * @returns true if the key is set
+         */
+        static bool get( const char* name, std::string* value );
+
+        /**
+         * @brief Records the fallback of an unset key as its effective value
+         */
+        static void set_default( const char* name, const std::string &value );
+
+        /**
+         * @brief Returns true if the key is known and the value matches its schema
+         */
+        static bool is_valid( const std::string &name, const std::string &value );
+
+        /**
+         * @brief Replaces the value of the given key until clear_overrides() is called
+         *
+         * @returns false if the key is unknown or the value is invalid
+         */
+        static bool set_override( const std::string &name, const std::string &value );
+
+        /**
+         * @brief Restores all values replaced by set_override()
+         */
+        static void clear_overrides();
+
+        /**
+         * @brief Returns the value as JSON number for numeric keys and as JSON string otherwise
+         */
+        static std::string value_to_json( const std::string &name, const std::string &value );
+
+        /**
+         * @brief Returns the effective config, all read keys with their values,
+         * as JSON object. Numbers are written as JSON numbers
+         */
+        static std::string to_json();
+
+        /**
+         * @brief Returns the unknown keys as JSON array
+         */
+        static std::string unknown_keys_to_json();
+
+};
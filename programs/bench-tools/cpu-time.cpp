@@ -0,0 +1,325 @@
+#include "./cpu-time.h"
+#include "./benchmark.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+// the fields after the closing bracket of the command that precede utime
+#define NUM_STAT_FIELDS_BEFORE_UTIME 11
+
+static inline const char* skip_field( const char* p, const char* end ) {
+    while (p < end && *p == ' ') p++;
+    while (p < end && *p != ' ') p++;
+    return p;
+}
+
+static inline const char* parse_number( const char* p, const char* end, uint64_t* value ) {
+    while (p < end && *p == ' ') p++;
+    if (p == end || *p < '0' || *p > '9') return nullptr;
+    *value = 0;
+    while (p < end && *p >= '0' && *p <= '9') *value = *value * 10 + (*p++ - '0');
+    return p;
+}
+
+CpuTimeSampler::~CpuTimeSampler() {
+    close();
+}
+
+bool CpuTimeSampler::read_stat( int fd, uint64_t* usr_ticks, uint64_t* sys_ticks ) {
+    const ssize_t n = pread(fd, m_aBuffer, CPU_TIME_BUFFER_SIZE, 0);
+    if (n <= 0) return false;
+    const char* end = m_aBuffer + n;
+
+    // the command may contain spaces, thus start after its closing bracket
+    const char* p = (const char*)memrchr(m_aBuffer, ')', n);
+    if (p == nullptr) return false;
+    p++;
+    for (unsigned int i = 0; i < NUM_STAT_FIELDS_BEFORE_UTIME; i++) p = skip_field(p, end);
+    p = parse_number(p, end, usr_ticks);
+    if (p == nullptr) return false;
+    return parse_number(p, end, sys_ticks) != nullptr;
+}
+
+bool CpuTimeSampler::read_schedstat( int fd, uint64_t* runtime ) {
+    const ssize_t n = pread(fd, m_aBuffer, CPU_TIME_BUFFER_SIZE, 0);
+    if (n <= 0) return false;
+    return parse_number(m_aBuffer, m_aBuffer + n, runtime) != nullptr;
+}
+
+bool CpuTimeSampler::read_status( int fd, uint64_t* voluntary_switches, uint64_t* nonvoluntary_switches ) {
+    static const char VOLUNTARY[] = "\nvoluntary_ctxt_switches:";
+    static const char NONVOLUNTARY[] = "\nnonvoluntary_ctxt_switches:";
+    const ssize_t n = pread(fd, m_aBuffer, CPU_TIME_BUFFER_SIZE, 0);
+    if (n <= 0) return false;
+    const char* end = m_aBuffer + n;
+    const char* p = (const char*)memmem(m_aBuffer, n, VOLUNTARY, sizeof(VOLUNTARY)-1);
+    const char* q = (const char*)memmem(m_aBuffer, n, NONVOLUNTARY, sizeof(NONVOLUNTARY)-1);
+    if (p == nullptr || q == nullptr) return false;
+    while (p < end && *p != '\t' && *p != ' ') p++;
+    while (q < end && *q != '\t' && *q != ' ') q++;
+    while (p < end && *p == '\t') p++;
+    while (q < end && *q == '\t') q++;
+    return parse_number(p, end, voluntary_switches) != nullptr && parse_number(q, end, nonvoluntary_switches) != nullptr;
+}
+
+static std::string read_task_name( const std::string &task_path ) {
+    char name[64];
+    const int fd = open((task_path + "/comm").c_str(), O_RDONLY);
+    if (fd == -1) return "";
+    const ssize_t n = read(fd, name, sizeof(name)-1);
+    close(fd);
+    if (n <= 0) return "";
+    return std::string(name, name[n-1] == '\n' ? n-1 : n);
+}
+
+bool CpuTimeSampler::open( const std::vector<std::string> &stat_filepaths ) {
+    struct stat s;
+    close();
+    m_lTicksPerSecond = sysconf(_SC_CLK_TCK);
+    if (m_lTicksPerSecond <= 0) m_lTicksPerSecond = 100;
+    m_aStatFilepaths = stat_filepaths;
+    m_aStatFds.assign(m_aStatFilepaths.size(), -1);
+    m_aTaskDirectories.assign(m_aStatFilepaths.size(), "");
+    m_aTaskIds.assign(m_aStatFilepaths.size(), std::vector<unsigned long>());
+    m_aSchedstatFds.assign(m_aStatFilepaths.size(), std::vector<int>());
+    m_aTaskStatFds.assign(m_aStatFilepaths.size(), std::vector<int>());
+    m_aTaskStatusFds.assign(m_aStatFilepaths.size(), std::vector<int>());
+    m_aTaskNames.assign(m_aStatFilepaths.size(), std::vector<std::string>());
+
+    for (unsigned int i = 0; i < m_aStatFilepaths.size(); i++) {
+        const std::string &path = m_aStatFilepaths[i];
+        m_aStatFds[i] = ::open(path.c_str(), O_RDONLY);
+        if (m_aStatFds[i] == -1) {
+            LOG_ERROR("Could not open stat file at \"%s\"! Error %d: %s\n", path.c_str(), errno, strerror(errno));
+            return false;
+        }
+
+        // look for the schedstat files next to the stat file. run.sh links the stat
+        // files of Occlum and Gramine, so resolve the link to the proc directory first
+        char* resolved = realpath(path.c_str(), nullptr);
+        const std::string real_path = resolved != nullptr ? resolved : path;
+        free(resolved);
+        if (real_path.size() < 5 || real_path.compare(real_path.size()-5, 5, "/stat") != 0) continue;
+        const std::string base = real_path.substr(0, real_path.size()-4);
+        if (stat((base + "task").c_str(), &s) == 0 && (s.st_mode & S_IFDIR)) {
+            m_aTaskDirectories[i] = base + "task";
+        } else {
+            const int fd = ::open((base + "schedstat").c_str(), O_RDONLY);
+            if (fd != -1) m_aSchedstatFds[i].push_back(fd);
+        }
+    }
+    refresh();
+    sample(&m_oBaseline);
+
+    for (unsigned int i = 0; i < m_aStatFilepaths.size(); i++) {
+        if (m_aSchedstatFds[i].empty()) LOG_INFO("No schedstat found for \"%s\", CPU times have a resolution of %ldHz\n", m_aStatFilepaths[i].c_str(), m_lTicksPerSecond);
+    }
+    return true;
+}
+
+void CpuTimeSampler::refresh() {
+    struct dirent *de;
+    for (unsigned int i = 0; i < m_aTaskDirectories.size(); i++) {
+        if (m_aTaskDirectories[i].empty()) continue;
+        DIR *d = opendir(m_aTaskDirectories[i].c_str());
+        if (d == nullptr) continue;
+        while ((de = readdir(d)) != nullptr) {
+            if (de->d_name[0] < '0' || de->d_name[0] > '9') continue;
+            const unsigned long tid = strtoul(de->d_name, nullptr, 10);
+            if (std::find(m_aTaskIds[i].begin(), m_aTaskIds[i].end(), tid) != m_aTaskIds[i].end()) continue;
+            const std::string task_path = m_aTaskDirectories[i] + "/" + de->d_name;
+            const int fd = ::open((task_path + "/schedstat").c_str(), O_RDONLY);
+            if (fd == -1 && !m_bPerThread) continue;
+
+            // per thread accounting needs the stat and status file of the task as well
+            if (m_bPerThread) {
+                const int stat_fd = ::open((task_path + "/stat").c_str(), O_RDONLY);
+                const int status_fd = ::open((task_path + "/status").c_str(), O_RDONLY);
+                if (stat_fd == -1 || status_fd == -1) {
+                    if (fd != -1) ::close(fd);
+                    if (stat_fd != -1) ::close(stat_fd);
+                    if (status_fd != -1) ::close(status_fd);
+                    continue;
+                }
+                m_aTaskStatFds[i].push_back(stat_fd);
+                m_aTaskStatusFds[i].push_back(status_fd);
+                m_aTaskNames[i].push_back(read_task_name(task_path));
+            }
+            m_aTaskIds[i].push_back(tid);
+            m_aSchedstatFds[i].push_back(fd);
+        }
+        closedir(d);
+    }
+}
+
+void CpuTimeSampler::close() {
+    for (unsigned int i = 0; i < m_aStatFds.size(); i++) {
+        if (m_aStatFds[i] != -1) ::close(m_aStatFds[i]);
+        for (unsigned int j = 0; j < m_aSchedstatFds[i].size(); j++) if (m_aSchedstatFds[i][j] != -1) ::close(m_aSchedstatFds[i][j]);
+        for (unsigned int j = 0; j < m_aTaskStatFds[i].size(); j++) ::close(m_aTaskStatFds[i][j]);
+        for (unsigned int j = 0; j < m_aTaskStatusFds[i].size(); j++) ::close(m_aTaskStatusFds[i][j]);
+    }
+    m_aStatFds.clear();
+    m_aTaskStatFds.clear();
+    m_aTaskStatusFds.clear();
+    m_aTaskNames.clear();
+    m_aTaskDirectories.clear();
+    m_aTaskIds.clear();
+    m_aSchedstatFds.clear();
+}
+
+void CpuTimeSampler::sample( CpuTimeSnapshot* snapshot ) {
+    const unsigned int n = m_aStatFds.size();
+    unsigned int k = 0;
+    snapshot->usr_ticks.resize(n);
+    snapshot->sys_ticks.resize(n);
+    snapshot->runtimes.resize(n);
+    snapshot->has_runtime.resize(n);
+    if (m_bPerThread) {
+        for (unsigned int i = 0; i < n; i++) k += m_aTaskStatFds[i].size();
+        snapshot->threads.resize(k);
+        k = 0;
+    }
+
+    for (unsigned int i = 0; i < n; i++) {
+        if (!read_stat(m_aStatFds[i], &snapshot->usr_ticks[i], &snapshot->sys_ticks[i])) {
+            LOG_ERROR("Could not read stat file at \"%s\"!\n", m_aStatFilepaths[i].c_str());
+            snapshot->usr_ticks[i] = snapshot->sys_ticks[i] = 0;
+        }
+
+        // a task that exited makes the sum incomparable, use the ticks then
+        uint64_t runtime;
+        snapshot->runtimes[i] = 0;
+        snapshot->has_runtime[i] = !m_aSchedstatFds[i].empty();
+        for (unsigned int j = 0; j < m_aSchedstatFds[i].size(); j++) {
+            const bool has_runtime = m_aSchedstatFds[i][j] != -1 && read_schedstat(m_aSchedstatFds[i][j], &runtime);
+            if (has_runtime) {
+                snapshot->runtimes[i] += runtime;
+            } else {
+                snapshot->has_runtime[i] = false;
+            }
+
+            // the counters of the task itself
+            if (!m_bPerThread || m_aTaskStatFds[i].empty()) continue;
+            ThreadCpuTime &thread = snapshot->threads[k++];
+            thread.runtime = has_runtime ? runtime : 0;
+            thread.has_runtime = has_runtime;
+            thread.valid = read_stat(m_aTaskStatFds[i][j], &thread.usr_ticks, &thread.sys_ticks)
+                && read_status(m_aTaskStatusFds[i][j], &thread.voluntary_switches, &thread.nonvoluntary_switches);
+        }
+    }
+}
+
+void CpuTimeSampler::split_runtime( double runtime, double usr_ticks, double sys_ticks, double all_usr_ticks, double all_sys_ticks, double* usr_micros, double* sys_micros ) {
+    double usr_share = 1.0;
+    if (usr_ticks + sys_ticks > 0) {
+        usr_share = usr_ticks / (usr_ticks + sys_ticks);
+    } else if (all_usr_ticks + all_sys_ticks > 0) {
+        usr_share = all_usr_ticks / (all_usr_ticks + all_sys_ticks);
+    }
+    *usr_micros += runtime * usr_share;
+    *sys_micros += runtime * (1.0 - usr_share);
+}
+
+void CpuTimeSampler::get_diff( const CpuTimeSnapshot &t1, const CpuTimeSnapshot &t2, double* usr_micros, double* sys_micros ) {
+    const double micros_per_tick = 1e6 / m_lTicksPerSecond;
+    *usr_micros = 0.0;
+    *sys_micros = 0.0;
+    if (t1.usr_ticks.size() != t2.usr_ticks.size()) {
+        LOG_ERROR("Tried to get the time diff from timestamps of different quantaties!\n");
+        return;
+    }
+
+    for (unsigned int i = 0; i < t1.usr_ticks.size(); i++) {
+        const double usr_ticks = t2.usr_ticks[i] - t1.usr_ticks[i];
+        const double sys_ticks = t2.sys_ticks[i] - t1.sys_ticks[i];
+        if (!t1.has_runtime[i] || !t2.has_runtime[i] || t2.runtimes[i] < t1.runtimes[i]) {
+            *usr_micros += usr_ticks * micros_per_tick;
+            *sys_micros += sys_ticks * micros_per_tick;
+            continue;
+        }
+
+        // split by the ticks of this interval or, if it was shorter than a
+        // tick, by all ticks since the files were opened
+        const double runtime = (t2.runtimes[i] - t1.runtimes[i]) / 1e3;
+        split_runtime(runtime, usr_ticks, sys_ticks, t2.usr_ticks[i] - m_oBaseline.usr_ticks[i], t2.sys_ticks[i] - m_oBaseline.sys_ticks[i], usr_micros, sys_micros);
+    }
+}
+
+void CpuTimeSampler::get_thread_diff( const CpuTimeSnapshot &t1, const CpuTimeSnapshot &t2, const std::vector<pid_t> &worker_ids, std::vector<ThreadUsage>* usages ) {
+    const double micros_per_tick = 1e6 / m_lTicksPerSecond;
+    unsigned int k = 0;
+    usages->clear();
+    if (t1.threads.size() != t2.threads.size()) {
+        LOG_ERROR("Tried to get the thread usages from snapshots of different quantaties!\n");
+        return;
+    }
+
+    for (unsigned int i = 0; i < m_aTaskStatFds.size(); i++) {
+        for (unsigned int j = 0; j < m_aTaskStatFds[i].size(); j++, k++) {
+            const ThreadCpuTime &a = t1.threads[k];
+            const ThreadCpuTime &b = t2.threads[k];
+            if (!a.valid || !b.valid) continue;
+
+            ThreadUsage usage;
+            usage.tid = m_aTaskIds[i][j];
+            usage.name = m_aTaskNames[i][j];
+            usage.is_worker = std::find(worker_ids.begin(), worker_ids.end(), (pid_t)usage.tid) != worker_ids.end();
+            usage.usr_time = 0.0;
+            usage.sys_time = 0.0;
+            usage.voluntary_switches = b.voluntary_switches - a.voluntary_switches;
+            usage.nonvoluntary_switches = b.nonvoluntary_switches - a.nonvoluntary_switches;
+            const double usr_ticks = b.usr_ticks - a.usr_ticks;
+            const double sys_ticks = b.sys_ticks - a.sys_ticks;
+            if (a.has_runtime && b.has_runtime && b.runtime >= a.runtime) {
+                split_runtime((b.runtime - a.runtime) / 1e3, usr_ticks, sys_ticks, b.usr_ticks, b.sys_ticks, &usage.usr_time, &usage.sys_time);
+            } else {
+                usage.usr_time = usr_ticks * micros_per_tick;
+                usage.sys_time = sys_ticks * micros_per_tick;
+            }
+            usages->push_back(usage);
+        }
+    }
+}
+
+static void thread_usage_sum_to_json( FILE* file, const std::vector<ThreadUsage> &usages, bool workers ) {
+    unsigned int num_threads = 0;
+    double usr_time = 0.0, sys_time = 0.0;
+    uint64_t voluntary_switches = 0, nonvoluntary_switches = 0;
+    for (unsigned int i = 0; i < usages.size(); i++) {
+        if (usages[i].is_worker != workers) continue;
+        num_threads++;
+        usr_time += usages[i].usr_time;
+        sys_time += usages[i].sys_time;
+        voluntary_switches += usages[i].voluntary_switches;
+        nonvoluntary_switches += usages[i].nonvoluntary_switches;
+    }
+    fprintf(file, "{\"numThreads\": %u, ", num_threads);
+    fprintf(file, "\"usrCpuTimeMicroseconds\": %.17g, ", usr_time);
+    fprintf(file, "\"sysCpuTimeMicroseconds\": %.17g, ", sys_time);
+    fprintf(file, "\"voluntaryContextSwitches\": %lu, ", (unsigned long)voluntary_switches);
+    fprintf(file, "\"nonvoluntaryContextSwitches\": %lu}", (unsigned long)nonvoluntary_switches);
+}
+
+void CpuTimeSampler::thread_usages_to_json( FILE* file, const std::vector<ThreadUsage> &usages ) {
+    fprintf(file, "{\"workers\": ");
+    thread_usage_sum_to_json(file, usages, true);
+    fprintf(file, ", \"others\": ");
+    thread_usage_sum_to_json(file, usages, false);
+    fprintf(file, ", \"threads\": [");
+    for (unsigned int i = 0; i < usages.size(); i++) {
+        fprintf(file, "{\"tid\": %lu, \"name\": \"", usages[i].tid);
+        for (const char c : usages[i].name) fputc(c == '"' || c == '\\' || (unsigned char)c < 0x20 ? '_' : c, file);
+        fprintf(file, "\", \"worker\": %s, ", usages[i].is_worker ? "true" : "false");
+        fprintf(file, "\"usrCpuTimeMicroseconds\": %.17g, ", usages[i].usr_time);
+        fprintf(file, "\"sysCpuTimeMicroseconds\": %.17g, ", usages[i].sys_time);
+        fprintf(file, "\"voluntaryContextSwitches\": %lu, ", (unsigned long)usages[i].voluntary_switches);
+        fprintf(file, "\"nonvoluntaryContextSwitches\": %lu}%s", (unsigned long)usages[i].nonvoluntary_switches, i==usages.size()-1 ? "" : ", ");
+    }
+    fprintf(file, "]}");
+}
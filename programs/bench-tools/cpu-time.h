@@ -0,0 +1,219 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+#define CPU_TIME_BUFFER_SIZE 4096
+
+/**
+ * @brief The counters of a single task at one point in time
+ */
+struct ThreadCpuTime {
+
+    // utime and stime in clock ticks
+    uint64_t usr_ticks;
+    uint64_t sys_ticks;
+
+    // the runtime from schedstat in nanoseconds
+    uint64_t runtime;
+    bool has_runtime;
+
+    // the context switches from the status file
+    uint64_t voluntary_switches;
+    uint64_t nonvoluntary_switches;
+
+    // false if the task exited or its files could not be parsed
+    bool valid;
+
+};
+
+/**
+ * @brief The CPU time and the context switches of a single thread between two snapshots
+ */
+struct ThreadUsage {
+
+    // the kernel thread id
+    unsigned long tid;
+
+    // the name of the thread (comm)
+    std::string name;
+
+    // true if the thread is one of the benchmark workers
+    bool is_worker;
+
+    // the time spent in user space and in the kernel in microseconds
+    double usr_time;
+    double sys_time;
+
+    // the amount of context switches
+    uint64_t voluntary_switches;
+    uint64_t nonvoluntary_switches;
+
+};
+
+/**
+ * @brief The CPU times of all stat files at one point in time
+ */
+struct CpuTimeSnapshot {
+
+    // the utime (field 14) of every stat file in clock ticks
+    std::vector<uint64_t> usr_ticks;
+
+    // the stime (field 15) of every stat file in clock ticks
+    std::vector<uint64_t> sys_ticks;
+
+    // the summed up runtime of all tasks of every stat file in nanoseconds
+    // from schedstat. 0 if schedstat is not available or could not be read
+    std::vector<uint64_t> runtimes;
+
+    // true for every stat file whose schedstat files could all be read
+    std::vector<bool> has_runtime;
+
+    // the counters of every task, only sampled if per thread accounting is enabled
+    std::vector<ThreadCpuTime> threads;
+
+};
+
+/**
+ * @brief Takes snapshots of the CPU time of the processes given by their stat
+ * files. The files stay open and are read with pread, so a snapshot neither
+ * allocates nor opens any file. The total CPU time is taken from the schedstat
+ * files of all tasks in nanoseconds if available and is split into usr and sys
+ * by the ratio of utime and stime, which only have a resolution of a clock tick
+ */
+class CpuTimeSampler {
+
+    protected:
+
+        // the stat files to sample
+        std::vector<std::string> m_aStatFilepaths;
+
+        // the open stat file of every process
+        std::vector<int> m_aStatFds;
+
+        // the task directory of every process, empty if not available
+        std::vector<std::string> m_aTaskDirectories;
+
+        // the ids of the tasks with an open schedstat file of every process
+        std::vector<std::vector<unsigned long>> m_aTaskIds;
+
+        // the open schedstat files of every process
+        std::vector<std::vector<int>> m_aSchedstatFds;
+
+        // the open stat and status files of every task, only with per thread accounting
+        std::vector<std::vector<int>> m_aTaskStatFds;
+        std::vector<std::vector<int>> m_aTaskStatusFds;
+
+        // the name of every task, only with per thread accounting
+        std::vector<std::vector<std::string>> m_aTaskNames;
+
+        // the CPU times when the files were opened
+        CpuTimeSnapshot m_oBaseline;
+
+        // the buffer all files are read into
+        char m_aBuffer[CPU_TIME_BUFFER_SIZE];
+
+        /**
+         * @brief Reads utime and stime from the given stat file
+         *
+         * @return False if the file could not be read or parsed
+         */
+        bool read_stat( int fd, uint64_t* usr_ticks, uint64_t* sys_ticks );
+
+        /**
+         * @brief Reads the runtime in nanoseconds from the given schedstat file
+         *
+         * @return False if the file could not be read or parsed
+         */
+        bool read_schedstat( int fd, uint64_t* runtime );
+
+        /**
+         * @brief Reads the voluntary and nonvoluntary context switches from the
+         * given status file
+         *
+         * @return False if the file could not be read or parsed
+         */
+        bool read_status( int fd, uint64_t* voluntary_switches, uint64_t* nonvoluntary_switches );
+
+        /**
+         * @brief Splits the runtime into usr and sys by the ratio of the ticks
+         * of the interval or, if no tick passed, by the ratio of all ticks
+         */
+        static void split_runtime( double runtime, double usr_ticks, double sys_ticks, double all_usr_ticks, double all_sys_ticks, double* usr_micros, double* sys_micros );
+
+    public:
+
+        // the clock ticks per second of utime and stime
+        long m_lTicksPerSecond = 100;
+
+        // if true, every snapshot also contains the counters of every task
+        bool m_bPerThread = false;
+
+        CpuTimeSampler() {}
+        CpuTimeSampler( const CpuTimeSampler& ) = delete;
+        CpuTimeSampler& operator=( const CpuTimeSampler& ) = delete;
+        ~CpuTimeSampler();
+
+        /**
+         * @brief Opens the given stat files and the schedstat files of their
+         * tasks. Schedstat files are looked up next to a stat file, i.e. for
+         * "/proc/<pid>/stat" in "/proc/<pid>/task/<tid>/schedstat" or in
+         * "/proc/<pid>/schedstat"
+         *
+         * @param stat_filepaths The stat files to sample
+         * @return False if a stat file could not be opened
+         */
+        bool open( const std::vector<std::string> &stat_filepaths );
+
+        /**
+         * @brief Opens the schedstat files of tasks that were created after the
+         * last call. Must not be called between two snapshots that get compared
+         */
+        void refresh();
+
+        /**
+         * @brief Closes all files
+         */
+        void close();
+
+        /**
+         * @brief Reads the current CPU times of all processes
+         *
+         * @param snapshot [OUT]: The snapshot to store the CPU times in
+         */
+        void sample( CpuTimeSnapshot* snapshot );
+
+        /**
+         * @brief Returns the CPU time that was spent between two snapshots
+         *
+         * @param t1 The first snapshot
+         * @param t2 The second snapshot
+         * @param usr_micros [OUT]: The time spent in user space in microseconds
+         * @param sys_micros [OUT]: The time spent in the kernel in microseconds
+         */
+        void get_diff( const CpuTimeSnapshot &t1, const CpuTimeSnapshot &t2, double* usr_micros, double* sys_micros );
+
+        /**
+         * @brief Returns the CPU time and the context switches of every task
+         * that was alive during both snapshots
+         *
+         * @param t1 The first snapshot
+         * @param t2 The second snapshot
+         * @param worker_ids The kernel thread ids of the benchmark workers
+         * @param usages [OUT]: The usage of every task
+         */
+        void get_thread_diff( const CpuTimeSnapshot &t1, const CpuTimeSnapshot &t2, const std::vector<pid_t> &worker_ids, std::vector<ThreadUsage>* usages );
+
+        /**
+         * @brief Writes the usages of all threads and their sums grouped into
+         * benchmark workers and all other threads as JSON object
+         *
+         * @param file The file to write the usages into
+         * @param usages The usages of the threads
+         */
+        static void thread_usages_to_json( FILE* file, const std::vector<ThreadUsage> &usages );
+
+};
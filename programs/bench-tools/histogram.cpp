@@ -0,0 +1,80 @@
+#include "./histogram.h"
+
+#include <algorithm>
+
+#define SUB_BUCKETS (1u << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+#define NUM_BUCKETS (SUB_BUCKETS + (LATENCY_HISTOGRAM_MAX_VALUE_BITS-LATENCY_HISTOGRAM_SUB_BUCKET_BITS)*(SUB_BUCKETS/2))
+
+LatencyHistogram::LatencyHistogram() : m_aCounts(NUM_BUCKETS, 0) {}
+
+uint64_t LatencyHistogram::get_bucket_lower_bound( unsigned int index ) {
+    if (index < SUB_BUCKETS) return index;
+    const unsigned int shift = (index-SUB_BUCKETS) / (SUB_BUCKETS/2) + 1;
+    const uint64_t sub_bucket = (index-SUB_BUCKETS) % (SUB_BUCKETS/2) + SUB_BUCKETS/2;
+    return sub_bucket << shift;
+}
+
+uint64_t LatencyHistogram::get_bucket_upper_bound( unsigned int index ) {
+    if (index < SUB_BUCKETS) return index;
+    const unsigned int shift = (index-SUB_BUCKETS) / (SUB_BUCKETS/2) + 1;
+    return get_bucket_lower_bound(index) + (1ull << shift) - 1;
+}
+
+void LatencyHistogram::merge( const LatencyHistogram &other ) {
+    for (unsigned int i = 0; i < m_aCounts.size(); i++) m_aCounts[i] += other.m_aCounts[i];
+    m_uNumSamples += other.m_uNumSamples;
+    m_dSum += other.m_dSum;
+    if (other.m_uMin < m_uMin) m_uMin = other.m_uMin;
+    if (other.m_uMax > m_uMax) m_uMax = other.m_uMax;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(m_aCounts.begin(), m_aCounts.end(), 0);
+    m_uNumSamples = 0;
+    m_uMin = UINT64_MAX;
+    m_uMax = 0;
+    m_dSum = 0.0;
+}
+
+double LatencyHistogram::get_percentile( double percentile ) const {
+    if (m_uNumSamples == 0) return 0.0;
+    if (percentile >= 100.0) return m_uMax / 1e3;
+
+    // find the bucket that contains the requested sample
+    const uint64_t target = (uint64_t)(percentile / 100.0 * m_uNumSamples) + 1;
+    uint64_t count = 0;
+    for (unsigned int i = 0; i < m_aCounts.size(); i++) {
+        count += m_aCounts[i];
+        if (count >= target) {
+            const uint64_t value = get_bucket_upper_bound(i);
+            return (value > m_uMax ? m_uMax : value) / 1e3;
+        }
+    }
+    return m_uMax / 1e3;
+}
+
+double LatencyHistogram::get_mean() const {
+    if (m_uNumSamples == 0) return 0.0;
+    return m_dSum / m_uNumSamples / 1e3;
+}
+
+void LatencyHistogram::to_json( FILE* file ) const {
+    bool first = true;
+    fprintf(file, "{\"numSamples\": %lu, ", m_uNumSamples);
+    fprintf(file, "\"mean\": %.17g, ", get_mean());
+    fprintf(file, "\"min\": %.17g, ", m_uNumSamples == 0 ? 0.0 : m_uMin / 1e3);
+    fprintf(file, "\"p50\": %.17g, ", get_percentile(50.0));
+    fprintf(file, "\"p90\": %.17g, ", get_percentile(90.0));
+    fprintf(file, "\"p99\": %.17g, ", get_percentile(99.0));
+    fprintf(file, "\"p999\": %.17g, ", get_percentile(99.9));
+    fprintf(file, "\"max\": %.17g, ", m_uMax / 1e3);
+
+    // only non-empty buckets as [lower bound in ns, count] to keep the files small
+    fprintf(file, "\"bucketsNanoseconds\": [");
+    for (unsigned int i = 0; i < m_aCounts.size(); i++) {
+        if (m_aCounts[i] == 0) continue;
+        fprintf(file, "%s[%lu, %lu]", first ? "" : ", ", get_bucket_lower_bound(i), m_aCounts[i]);
+        first = false;
+    }
+    fprintf(file, "]}");
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+// values below 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS nanoseconds are stored exactly, larger
+// values with a relative error of at most 2^-(LATENCY_HISTOGRAM_SUB_BUCKET_BITS-1)
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 7
+
+// the largest value that can be recorded (2^40ns ~ 18 minutes), larger values get clamped
+#define LATENCY_HISTOGRAM_MAX_VALUE_BITS 40
+
+/**
+ * @brief A log-linear (HDR-style) histogram of latencies in nanoseconds. Each
+ * power of two range is split into a fixed amount of linear sub buckets. A
+ * histogram must only be written by one thread at a time, thus every thread
+ * gets its own instance that is merged after the threads have been joined
+ */
+class LatencyHistogram {
+
+    private:
+
+        // the amount of samples in every bucket
+        std::vector<uint64_t> m_aCounts;
+
+        /**
+         * @brief Returns the index of the bucket that the given value falls into
+         */
+        static inline unsigned int get_bucket_index( uint64_t value ) {
+            const unsigned int SUB_BUCKETS = 1u << LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+            if (value < SUB_BUCKETS) return value;
+            const unsigned int shift = 63 - __builtin_clzll(value) - (LATENCY_HISTOGRAM_SUB_BUCKET_BITS-1);
+            return SUB_BUCKETS + (shift-1)*(SUB_BUCKETS/2) + (unsigned int)(value >> shift) - SUB_BUCKETS/2;
+        }
+
+        /**
+         * @brief Returns the lowest value that falls into the given bucket
+         */
+        static uint64_t get_bucket_lower_bound( unsigned int index );
+
+        /**
+         * @brief Returns the highest value that falls into the given bucket
+         */
+        static uint64_t get_bucket_upper_bound( unsigned int index );
+
+    public:
+
+        // the amount of recorded samples
+        uint64_t m_uNumSamples = 0;
+
+        // the smallest recorded value in nanoseconds
+        uint64_t m_uMin = UINT64_MAX;
+
+        // the largest recorded value in nanoseconds
+        uint64_t m_uMax = 0;
+
+        // the sum of all recorded values in nanoseconds
+        double m_dSum = 0.0;
+
+        LatencyHistogram();
+
+        /**
+         * @brief Adds a single latency to the histogram
+         *
+         * @param nanoseconds The latency in nanoseconds
+         */
+        inline void record( uint64_t nanoseconds ) {
+            if (nanoseconds >= (1ull << LATENCY_HISTOGRAM_MAX_VALUE_BITS)) nanoseconds = (1ull << LATENCY_HISTOGRAM_MAX_VALUE_BITS) - 1;
+            m_aCounts[get_bucket_index(nanoseconds)]++;
+            m_uNumSamples++;
+            m_dSum += nanoseconds;
+            if (nanoseconds < m_uMin) m_uMin = nanoseconds;
+            if (nanoseconds > m_uMax) m_uMax = nanoseconds;
+        }
+
+        /**
+         * @brief Adds all samples of the other histogram to this one
+         */
+        void merge( const LatencyHistogram &other );
+
+        /**
+         * @brief Removes all samples
+         */
+        void reset();
+
+        /**
+         * @brief Returns the value at the given percentile in microseconds. The
+         * upper bound of the matching bucket is returned
+         *
+         * @param percentile The percentile in the range [0, 100]
+         */
+        double get_percentile( double percentile ) const;
+
+        /**
+         * @brief Returns the mean of all samples in microseconds
+         */
+        double get_mean() const;
+
+        /**
+         * @brief Writes the percentiles and all non-empty buckets as JSON object
+         *
+         * @param file The file to write the histogram into
+         */
+        void to_json( FILE* file ) const;
+
+};
@@ -0,0 +1,57 @@
+#include "./io-batching.h"
+#include "./benchmark.h"
+
+#include <limits.h>
+
+const char* IoBatching::get_variant_name() const {
+    if (m_uVectors > 1) return "vectored";
+    if (m_uCoalesce > 1) return "coalesced";
+    return "single";
+}
+
+unsigned int IoBatching::get_buffers_per_call() const {
+    return std::max(std::max(m_uVectors, m_uCoalesce), 1u);
+}
+
+std::string IoBatching::to_json( const Batch &batch, size_t buffer_size ) const {
+    char s[64];
+    const double bytes_per_call = (double)buffer_size * get_buffers_per_call();
+    std::string res = "\"io\": {";
+    res += std::string("\"variant\": \"") + get_variant_name() + "\"";
+    res += ", \"vectors\": " + std::to_string(m_uVectors);
+    res += ", \"coalesce\": " + std::to_string(m_uCoalesce);
+    res += ", \"bytesPerCall\": " + std::to_string((unsigned long)bytes_per_call);
+    snprintf(s, sizeof(s), "%.17g", 1.0 / bytes_per_call);
+    res += std::string(", \"syscallsPerByte\": ") + s;
+
+    // the bytes of all threads per second, from the mean runtime of a call
+    res += ", \"bytesPerSecond\": [";
+    for (unsigned int i = 0; i < batch.m_uNumExecutedBatches; i++) {
+        const Benchmark &benchmark = batch.m_pBenchmarks[i];
+        snprintf(s, sizeof(s), "%.17g", benchmark.m_dThreadDurationMean > 0.0 ? benchmark.m_uNumThreads * bytes_per_call * 1e6 / benchmark.m_dThreadDurationMean : 0.0);
+        res += std::string(i == 0 ? "" : ", ") + s;
+    }
+    res += "]}";
+    return res;
+}
+
+void IoBatching::process_environment_variables( IoBatching* batching ) {
+    if (batching == nullptr) return;
+
+    // the buffers per pwritev/preadv call, 1 uses pwrite/pread
+    batching->m_uVectors = get_config("BM_IO_VECTORS", (long)1);
+    if (batching->m_uVectors > IOV_MAX) {
+        LOG_WARN("At most %d buffers fit into a single call, using %d instead of %u!\n", IOV_MAX, IOV_MAX, batching->m_uVectors);
+        batching->m_uVectors = IOV_MAX;
+    }
+    if (batching->m_uVectors == 0) batching->m_uVectors = 1;
+
+    // the writes that get copied into a staging buffer and written with a single pwrite
+    batching->m_uCoalesce = get_config("BM_IO_COALESCE", (long)1);
+    if (batching->m_uCoalesce == 0) batching->m_uCoalesce = 1;
+    if (batching->m_uVectors > 1 && batching->m_uCoalesce > 1) {
+        LOG_WARN("The vectored and the coalesced variant exclude each other, ignoring BM_IO_COALESCE!\n");
+        batching->m_uCoalesce = 1;
+    }
+
+}
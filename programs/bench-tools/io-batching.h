@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+
+class Batch;
+
+/**
+ * @brief How the I/O routines pack their buffers into system calls. An
+ * execution is always a single system call, it either carries one buffer
+ * (pwrite/pread), m_uVectors buffers (pwritev/preadv) or m_uCoalesce buffers
+ * that got copied into a staging buffer first (a single larger pwrite). The
+ * bytes per second and the system calls per byte make the variants comparable
+ */
+class IoBatching {
+
+    public:
+
+        // the buffers per pwritev/preadv call, 1 uses pwrite/pread
+        unsigned int m_uVectors = 1;
+
+        // the writes copied into a staging buffer and written with a single pwrite, 1 disables it
+        unsigned int m_uCoalesce = 1;
+
+        /**
+         * @brief Returns the name of the variant as written into the results:
+         * "single", "vectored" or "coalesced"
+         */
+        const char* get_variant_name() const;
+
+        /**
+         * @brief Returns the amount of buffers moved by a single system call
+         */
+        unsigned int get_buffers_per_call() const;
+
+        /**
+         * @brief Returns the variant, the bytes per second of every batch and the
+         * system calls per byte as JSON property "io"
+         *
+         * @param batch The executed batch
+         * @param buffer_size The size of a single buffer in bytes
+         */
+        std::string to_json( const Batch &batch, size_t buffer_size ) const;
+
+        /**
+         * @brief Checks the environment variables for matching parameters
+         *
+         * @param batching [OUT]: The buffers per system call
+         */
+        static void process_environment_variables( IoBatching* batching );
+
+};
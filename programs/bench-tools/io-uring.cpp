@@ -0,0 +1,268 @@
+#include "./io-uring.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// older C libraries do not define the system call numbers yet
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+
+// the time in milliseconds the poll thread keeps polling without submissions before it sleeps
+#define IO_URING_SQ_THREAD_IDLE 1000
+
+IoUring::~IoUring() {
+    close();
+}
+
+int IoUring::setup( unsigned int entries, bool sqpoll ) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    if (sqpoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = IO_URING_SQ_THREAD_IDLE;
+    }
+    m_iFd = syscall(__NR_io_uring_setup, entries, &params);
+    if (m_iFd < 0) {
+        m_iFd = -1;
+        return -errno;
+    }
+    m_uFlags = params.flags;
+
+    // map the rings, both live in the same mapping if the kernel supports it
+    m_uSqRingSize = params.sq_off.array + params.sq_entries*sizeof(unsigned int);
+    m_uCqRingSize = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) m_uSqRingSize = m_uCqRingSize = std::max(m_uSqRingSize, m_uCqRingSize);
+    m_pSqRing = mmap(nullptr, m_uSqRingSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_iFd, IORING_OFF_SQ_RING);
+    if (m_pSqRing == MAP_FAILED) {
+        const int error = errno;
+        m_pSqRing = nullptr;
+        close();
+        return -error;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        m_pCqRing = m_pSqRing;
+    } else {
+        m_pCqRing = mmap(nullptr, m_uCqRingSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_iFd, IORING_OFF_CQ_RING);
+        if (m_pCqRing == MAP_FAILED) {
+            const int error = errno;
+            m_pCqRing = nullptr;
+            close();
+            return -error;
+        }
+    }
+    m_uSqesSize = params.sq_entries*sizeof(io_uring_sqe);
+    m_pSqes = (io_uring_sqe*)mmap(nullptr, m_uSqesSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_iFd, IORING_OFF_SQES);
+    if (m_pSqes == MAP_FAILED) {
+        const int error = errno;
+        m_pSqes = nullptr;
+        close();
+        return -error;
+    }
+
+    // the entries are always used in order, thus the index array is the identity
+    char* sq = (char*)m_pSqRing;
+    char* cq = (char*)m_pCqRing;
+    m_pSqHead = (unsigned int*)(sq + params.sq_off.head);
+    m_pSqTail = (unsigned int*)(sq + params.sq_off.tail);
+    m_pSqFlags = (unsigned int*)(sq + params.sq_off.flags);
+    m_uSqMask = *(unsigned int*)(sq + params.sq_off.ring_mask);
+    m_uSqEntries = *(unsigned int*)(sq + params.sq_off.ring_entries);
+    unsigned int* array = (unsigned int*)(sq + params.sq_off.array);
+    for (unsigned int i = 0; i < m_uSqEntries; i++) array[i] = i;
+    m_uSqTail = *m_pSqTail;
+    m_pCqHead = (unsigned int*)(cq + params.cq_off.head);
+    m_pCqTail = (unsigned int*)(cq + params.cq_off.tail);
+    m_uCqMask = *(unsigned int*)(cq + params.cq_off.ring_mask);
+    m_pCqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+    return 0;
+}
+
+void IoUring::close() {
+    if (m_pSqes != nullptr) munmap(m_pSqes, m_uSqesSize);
+    if (m_pCqRing != nullptr && m_pCqRing != m_pSqRing) munmap(m_pCqRing, m_uCqRingSize);
+    if (m_pSqRing != nullptr) munmap(m_pSqRing, m_uSqRingSize);
+    if (m_iFd != -1) ::close(m_iFd);
+    m_pSqes = nullptr;
+    m_pCqRing = m_pSqRing = nullptr;
+    m_iFd = -1;
+}
+
+int IoUring::register_buffers( const struct iovec* buffers, unsigned int num_buffers ) {
+    return syscall(__NR_io_uring_register, m_iFd, IORING_REGISTER_BUFFERS, buffers, num_buffers) < 0 ? -errno : 0;
+}
+
+int IoUring::register_files( const int* fds, unsigned int num_fds ) {
+    return syscall(__NR_io_uring_register, m_iFd, IORING_REGISTER_FILES, fds, num_fds) < 0 ? -errno : 0;
+}
+
+bool IoUring::is_sqpoll() const {
+    return (m_uFlags & IORING_SETUP_SQPOLL) != 0;
+}
+
+int IoUring::submit( unsigned int wait_nr ) {
+    const unsigned int to_submit = m_uSqTail - *m_pSqTail;
+    unsigned int flags = wait_nr == 0 ? 0 : IORING_ENTER_GETEVENTS;
+    if (to_submit != 0) __atomic_store_n(m_pSqTail, m_uSqTail, __ATOMIC_RELEASE);
+
+    // the poll thread picks the entries up on its own, it only has to be woken up once it fell asleep
+    if (is_sqpoll()) {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (to_submit != 0 && (__atomic_load_n(m_pSqFlags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP)) flags |= IORING_ENTER_SQ_WAKEUP;
+        if (flags == 0) return to_submit;
+    } else if (to_submit == 0 && wait_nr == 0) {
+        return 0;
+    }
+    const int res = syscall(__NR_io_uring_enter, m_iFd, is_sqpoll() ? 0 : to_submit, wait_nr, flags, nullptr, 0);
+    return res < 0 ? -errno : (is_sqpoll() ? to_submit : res);
+}
+
+
+
+
+
+void IoUringBenchmark::measure_single_thread( double* mean_duration, unsigned int thread_num, LatencyHistogram* histogram ) {
+    IoUring &ring = m_pRings[thread_num];
+    std::atomic<uint64_t>* ops = m_oTimelineRecorder.get_counter(thread_num);
+    const unsigned int batch_size = m_uBatchSize == 0 ? m_uQueueDepth : std::min(m_uBatchSize, m_uQueueDepth);
+    unsigned int submitted = 0, completed = 0, in_flight = 0;
+    uint64_t t1, t2;
+
+    // do actual benchmark
+    t1 = Clock::now();
+    while (completed < m_uNumExecutions) {
+
+        // queue a batch of operations without exceeding the queue depth, the sampled
+        // operations carry their submission time
+        const unsigned int count = std::min(std::min(batch_size, m_uQueueDepth-in_flight), m_uNumExecutions-submitted);
+        for (unsigned int i = 0; i < count; i++) {
+            const bool sampled = histogram != nullptr && (submitted+i) % m_uLatencySampleInterval == 0;
+            prepare(ring.get_sqe(), thread_num, sampled ? Clock::now() : 0);
+        }
+        submitted += count;
+        in_flight += count;
+
+        // wait for a batch of completions once the queue is full or everything is submitted
+        const unsigned int wait_nr = in_flight == m_uQueueDepth || submitted == m_uNumExecutions ? std::min(batch_size, in_flight) : 0;
+        const int res = ring.submit(wait_nr);
+        if (res < 0 && res != -EINTR && res != -EAGAIN && res != -EBUSY) {
+            LOG_ERROR("Could not submit to io_uring! Error %d: %s\n", -res, strerror(-res));
+            break;
+        }
+        const unsigned int reaped = ring.reap([&]( const io_uring_cqe &cqe ) {
+            if (cqe.res < 0) LOG_ERROR("Could not %s file! Error %d: %s\n", m_eOperation == IoOperation::WRITE ? "write to" : "read", -cqe.res, strerror(-cqe.res));
+            if (cqe.user_data != 0) histogram->record(Clock::to_nanos(Clock::now()-cqe.user_data));
+        });
+        completed += reaped;
+        in_flight -= reaped;
+        if (ops != nullptr) ops->store(completed, std::memory_order_relaxed);
+
+    }
+    t2 = Clock::now();
+
+    // store result
+    *mean_duration = Clock::to_micros(t2-t1) / m_uNumExecutions;
+}
+
+void IoUringBenchmark::run() {
+
+    if (m_pRings == nullptr) throw new std::runtime_error("The rings must be opened before the benchmark runs!");
+    if (m_uQueueDepth < 1) throw new std::runtime_error("The queue depth must be at least one!");
+
+    // each thread uses its own ring
+    Benchmark::run();
+
+}
+
+bool IoUringBenchmark::open_rings( const std::vector<int> &fds, const std::vector<char*> &buffers, size_t buffer_size ) {
+    if (m_pRings != nullptr) {
+        LOG_WARN("Tried to open the rings for the io_uring benchmark, but they are already opened!\n");
+        return true;
+    }
+    if (fds.size() < m_uNumThreads || buffers.size() < m_uNumThreads) {
+        LOG_ERROR("The io_uring benchmark needs a file and a buffer for each of the %u threads!\n", m_uNumThreads);
+        return false;
+    }
+    m_aRingFileDescriptors = fds;
+    m_aRingBuffers = buffers;
+    m_uRingBufferSize = buffer_size;
+    m_pRings = new IoUring[m_uNumThreads];
+
+    for (unsigned int i = 0; i < m_uNumThreads; i++) {
+        TRACE_SPAN("open ring");
+        int res = m_pRings[i].setup(m_uQueueDepth, m_bSqPoll);
+
+        // the poll thread needs privileges on older kernels
+        if (res == -EPERM && m_bSqPoll && i == 0) {
+            LOG_WARN("Could not set up io_uring with a poll thread, continuing without!\n");
+            m_bSqPoll = false;
+            res = m_pRings[i].setup(m_uQueueDepth, m_bSqPoll);
+        }
+        if (res == 0 && m_bRegisterBuffers) {
+            struct iovec iov = {buffers[i], buffer_size};
+            res = m_pRings[i].register_buffers(&iov, 1);
+        }
+        if (res == 0 && m_bRegisterFiles) res = m_pRings[i].register_files(&m_aRingFileDescriptors[i], 1);
+        if (res != 0) {
+            LOG_ERROR("Could not set up io_uring! Error %d: %s\n", -res, strerror(-res));
+            close_rings();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IoUringBenchmark::open_rings() {
+    if (m_pFileDescriptors == nullptr) {
+        LOG_ERROR("The temporary files must be opened before the rings!\n");
+        return false;
+    }
+    std::vector<char*> buffers;
+    for (unsigned int i = 0; i < m_uNumThreads; i++) buffers.push_back(m_oBuffers.get(i));
+    return open_rings(std::vector<int>(m_pFileDescriptors, m_pFileDescriptors+m_uNumThreads), buffers, m_uBufferSize);
+}
+
+void IoUringBenchmark::close_rings() {
+    delete[] m_pRings;
+    m_pRings = nullptr;
+}
+
+std::string IoUringBenchmark::settings_to_json() const {
+    std::string res = "\"ioUring\": {";
+    res += "\"queueDepth\": " + std::to_string(m_uQueueDepth);
+    res += ", \"batchSize\": " + std::to_string(m_uBatchSize == 0 ? m_uQueueDepth : std::min(m_uBatchSize, m_uQueueDepth));
+    res += std::string(", \"sqpoll\": ") + (m_bSqPoll ? "true" : "false");
+    res += std::string(", \"registeredBuffers\": ") + (m_bRegisterBuffers ? "true" : "false");
+    res += std::string(", \"registeredFiles\": ") + (m_bRegisterFiles ? "true" : "false");
+    res += "}";
+    return res;
+}
+
+void IoUringBenchmark::process_environment_variables( bool* use_io_uring, unsigned int* queue_depth, unsigned int* batch_size, bool* sqpoll, bool* register_buffers, bool* register_files ) {
+
+    // sync issues one system call per execution, io_uring queues the executions on a ring per thread
+    if (use_io_uring != nullptr) *use_io_uring = get_config("BM_IO_BACKEND", std::string("sync")) == "io_uring";
+
+    // the maximum amount of operations in flight per thread
+    if (queue_depth != nullptr) *queue_depth = get_config("BM_IOURING_QUEUE_DEPTH", (long)1);
+
+    // the operations per system call, 0 uses the queue depth
+    if (batch_size != nullptr) *batch_size = get_config("BM_IOURING_BATCH", (long)0);
+
+    // poll the submission queues with a kernel thread
+    if (sqpoll != nullptr) *sqpoll = get_config("BM_IOURING_SQPOLL", (long)0) != 0;
+
+    // register the buffer and the files with the rings
+    if (register_buffers != nullptr) *register_buffers = get_config("BM_IOURING_REGISTER_BUFFERS", (long)0) != 0;
+    if (register_files != nullptr) *register_files = get_config("BM_IOURING_REGISTER_FILES", (long)0) != 0;
+
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "./benchmark.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+/**
+ * @brief A submission and completion queue of io_uring, set up with the raw
+ * system calls so no liburing is needed. Only a single thread may use a ring
+ * at a time
+ */
+class IoUring {
+
+    private:
+
+        // the file descriptor of the ring, -1 if not set up
+        int m_iFd = -1;
+
+        // the flags the ring was set up with
+        unsigned int m_uFlags = 0;
+
+        // the mapped submission queue ring, completion queue ring and submission queue entries
+        void* m_pSqRing = nullptr;
+        size_t m_uSqRingSize = 0;
+        void* m_pCqRing = nullptr;
+        size_t m_uCqRingSize = 0;
+        io_uring_sqe* m_pSqes = nullptr;
+        size_t m_uSqesSize = 0;
+
+        // the fields of the submission queue ring
+        unsigned int* m_pSqHead = nullptr;
+        unsigned int* m_pSqTail = nullptr;
+        unsigned int* m_pSqFlags = nullptr;
+        unsigned int m_uSqMask = 0;
+        unsigned int m_uSqEntries = 0;
+
+        // the fields of the completion queue ring
+        unsigned int* m_pCqHead = nullptr;
+        unsigned int* m_pCqTail = nullptr;
+        unsigned int m_uCqMask = 0;
+        io_uring_cqe* m_pCqes = nullptr;
+
+        // the tail including the entries that were handed out by get_sqe() but not submitted yet
+        unsigned int m_uSqTail = 0;
+
+    public:
+
+        IoUring() {}
+        IoUring( const IoUring& ) = delete;
+        IoUring& operator=( const IoUring& ) = delete;
+        ~IoUring();
+
+        /**
+         * @brief Creates the ring and maps its queues
+         *
+         * @param entries The amount of submission queue entries, rounded up to a power of two
+         * @param sqpoll Whether a kernel thread polls the submission queue, so
+         * submitting needs no system call while the thread is awake
+         * @returns 0 on success, the negative error number otherwise
+         */
+        int setup( unsigned int entries, bool sqpoll );
+
+        /**
+         * @brief Unmaps the queues and closes the ring
+         */
+        void close();
+
+        /**
+         * @brief Registers the buffers for IORING_OP_READ_FIXED and IORING_OP_WRITE_FIXED
+         *
+         * @returns 0 on success, the negative error number otherwise
+         */
+        int register_buffers( const struct iovec* buffers, unsigned int num_buffers );
+
+        /**
+         * @brief Registers the files for IOSQE_FIXED_FILE, the index in the array replaces the fd
+         *
+         * @returns 0 on success, the negative error number otherwise
+         */
+        int register_files( const int* fds, unsigned int num_fds );
+
+        /**
+         * @brief Returns true if a kernel thread polls the submission queue
+         */
+        bool is_sqpoll() const;
+
+        /**
+         * @brief Returns the next free submission queue entry, cleared, or nullptr
+         * if the queue is full. It gets submitted by the next submit() call
+         */
+        inline io_uring_sqe* get_sqe() {
+            const unsigned int head = __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE);
+            if (m_uSqTail - head >= m_uSqEntries) return nullptr;
+            io_uring_sqe* sqe = &m_pSqes[m_uSqTail & m_uSqMask];
+            m_uSqTail++;
+            memset(sqe, 0, sizeof(*sqe));
+            return sqe;
+        }
+
+        /**
+         * @brief Submits all entries returned by get_sqe() since the last call
+         * with a single system call, or none if the poll thread is awake
+         *
+         * @param wait_nr The amount of completions to wait for
+         * @returns The amount of submitted entries, the negative error number on failure
+         */
+        int submit( unsigned int wait_nr = 0 );
+
+        /**
+         * @brief Calls the given function for every available completion and frees them
+         *
+         * @param on_completion Gets the completion queue entry as parameter
+         * @returns The amount of completions
+         */
+        template<typename Function>
+        inline unsigned int reap( Function on_completion ) {
+            unsigned int head = *m_pCqHead;
+            const unsigned int tail = __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE);
+            const unsigned int count = tail - head;
+            for (; head != tail; head++) on_completion(m_pCqes[head & m_uCqMask]);
+            __atomic_store_n(m_pCqHead, head, __ATOMIC_RELEASE);
+            return count;
+        }
+
+};
+
+enum class IoOperation {
+    WRITE,
+    READ
+};
+
+/**
+ * @brief Writes or reads the buffer with io_uring instead of one synchronous
+ * system call per execution. Every thread has its own ring and keeps up to
+ * m_uQueueDepth operations in flight, submitting and reaping them in batches
+ * of m_uBatchSize. An execution is a single operation, so the runtimes are
+ * comparable to the synchronous routines. The latency histogram records the
+ * time from the submission to the completion of the sampled operations
+ */
+class IoUringBenchmark : public WriteBenchmark {
+
+    protected:
+
+        // the ring of every thread
+        IoUring* m_pRings = nullptr;
+
+        // the file every thread writes into or reads from
+        std::vector<int> m_aRingFileDescriptors;
+
+        // the buffer every thread writes or reads
+        std::vector<char*> m_aRingBuffers;
+        size_t m_uRingBufferSize = 0;
+
+        /**
+         * @brief Fills the submission queue entry for an operation of the given thread
+         */
+        inline void prepare( io_uring_sqe* sqe, unsigned int thread_num, uint64_t user_data ) const {
+            if (m_eOperation == IoOperation::WRITE) sqe->opcode = m_bRegisterBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+            else sqe->opcode = m_bRegisterBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+            sqe->fd = m_bRegisterFiles ? 0 : m_aRingFileDescriptors[thread_num];
+            if (m_bRegisterFiles) sqe->flags = IOSQE_FIXED_FILE;
+            sqe->addr = (uint64_t)m_aRingBuffers[thread_num];
+            sqe->len = m_uRingBufferSize;
+            sqe->off = 0;
+            sqe->buf_index = 0;
+            sqe->user_data = user_data;
+        }
+
+        void measure_single_thread( double* mean_duration, unsigned int thread_num, LatencyHistogram* histogram = nullptr ) override;
+
+    public:
+
+        // whether to write or read the buffer
+        IoOperation m_eOperation = IoOperation::WRITE;
+
+        // the maximum amount of operations in flight per thread
+        unsigned int m_uQueueDepth = 1;
+
+        // the amount of operations submitted and reaped per system call. 0 uses the queue depth
+        unsigned int m_uBatchSize = 0;
+
+        // whether a kernel thread polls the submission queues
+        bool m_bSqPoll = false;
+
+        // whether the buffer and the files are registered with the rings
+        bool m_bRegisterBuffers = false;
+        bool m_bRegisterFiles = false;
+
+        /**
+         * @brief Runs the benchmark on the rings, open_rings() must be called before
+         */
+        void run() override;
+
+        /**
+         * @brief Sets up a ring for every thread
+         *
+         * @param fds The file of every thread
+         * @param buffers The buffer every thread writes or reads
+         * @param buffer_size The amount of bytes per operation
+         * @returns false if a ring could not be set up
+         */
+        bool open_rings( const std::vector<int> &fds, const std::vector<char*> &buffers, size_t buffer_size );
+
+        /**
+         * @brief Sets up a ring for every thread on the temporary files and the buffers
+         * of open_tmp_files()
+         */
+        bool open_rings();
+
+        /**
+         * @brief Closes the rings of all threads
+         */
+        void close_rings();
+
+        /**
+         * @brief Returns the effective settings of the rings as JSON property "ioUring"
+         */
+        std::string settings_to_json() const;
+
+        /**
+         * @brief Checks the environment variables for matching parameters
+         * to modify the benchmark
+         *
+         * @param use_io_uring [OUT]: Whether the routines use io_uring instead of
+         * synchronous system calls
+         * @param queue_depth [OUT]: The maximum amount of operations in flight per thread
+         * @param batch_size [OUT]: The amount of operations per system call
+         * @param sqpoll [OUT]: Whether a kernel thread polls the submission queues
+         * @param register_buffers [OUT]: Whether the buffer is registered with the rings
+         * @param register_files [OUT]: Whether the files are registered with the rings
+         */
+        static void process_environment_variables( bool* use_io_uring = nullptr, unsigned int* queue_depth = nullptr, unsigned int* batch_size = nullptr, bool* sqpoll = nullptr, bool* register_buffers = nullptr, bool* register_files = nullptr );
+
+};
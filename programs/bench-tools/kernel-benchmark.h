@@ -0,0 +1,171 @@
+#pragma once
+
+#include "./benchmark.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Checks whether a kernel has a static run_n( self, thread_num, count ) function
+ */
+template<typename Kernel, typename Base, typename = void>
+struct kernel_has_run_n : std::false_type {};
+
+template<typename Kernel, typename Base>
+struct kernel_has_run_n<Kernel, Base, decltype(Kernel::run_n(std::declval<Base*>(), 0u, 0u), void())> : std::true_type {};
+
+/**
+ * @brief A benchmark that calls the kernel directly in the timed loop instead
+ * of through m_pFunction, so the compiler can inline it. A kernel is a struct
+ * with a static function run( Base* self, unsigned int thread_num ) and an
+ * optional static function run_n( Base* self, unsigned int thread_num, unsigned
+ * int count ) that executes the kernel count times, e.g. with an unrolled loop
+ *
+ * @tparam Kernel The kernel to benchmark
+ * @tparam Base The benchmark class to extend, e.g. WriteBenchmark
+ */
+template<typename Kernel, typename Base = Benchmark>
+class KernelBenchmark;
+
+/**
+ * @brief A kernel that does nothing. The empty asm statement keeps the compiler
+ * from removing the timed loop, so only the overhead of the harness remains
+ */
+struct NullKernel {
+
+    static inline void run( Benchmark* self, unsigned int thread_num ) {
+        __asm__ __volatile__( "" : : : "memory" );
+    }
+
+};
+
+template<typename Kernel, typename Base>
+class KernelBenchmark : public Base {
+
+    private:
+
+        /**
+         * @brief Calls the kernel count times, either with its own run_n() or in a loop
+         */
+        static inline void invoke_n( Base* self, unsigned int thread_num, unsigned int count, std::true_type ) {
+            Kernel::run_n(self, thread_num, count);
+        }
+        static inline void invoke_n( Base* self, unsigned int thread_num, unsigned int count, std::false_type ) {
+            for (unsigned int i = 0; i < count; i++) Kernel::run(self, thread_num);
+        }
+
+        /**
+         * @brief Calls the kernel once. Used as m_pFunction for benchmarks that
+         * don't use the timed loop, e.g. FrequencyBenchmark
+         */
+        static void invoke( void* self, unsigned int thread_num ) {
+            Kernel::run((Base*)self, thread_num);
+        }
+
+    protected:
+
+        void measure_single_thread( double* mean_duration, unsigned int thread_num, LatencyHistogram* histogram = nullptr ) override {
+            Base* self = this;
+            Benchmark::measure_loop(
+                this,
+                thread_num,
+                mean_duration,
+                histogram,
+                [self, thread_num]() { Kernel::run(self, thread_num); },
+                [self, thread_num]( unsigned int count ) { invoke_n(self, thread_num, count, kernel_has_run_n<Kernel, Base>()); }
+            );
+        }
+
+    public:
+
+        template<typename... Args>
+        KernelBenchmark( Args... args ) : Base(args...) {
+            this->m_pFunction = invoke;
+        }
+
+        Benchmark* create_null_benchmark() const override {
+            return new KernelBenchmark<NullKernel>();
+        }
+
+};
+
+/**
+ * @brief Writes the buffer of the thread into its file
+ *
+ * @tparam BufferSize The amount of bytes to write. 0 uses m_uBufferSize
+ */
+template<size_t BufferSize>
+struct WriteKernel {
+
+    static inline void run( WriteBenchmark* self, unsigned int thread_num ) {
+        if (pwrite(self->m_pFileDescriptors[thread_num], self->m_oBuffers.get(thread_num), BufferSize == 0 ? self->m_uBufferSize : BufferSize, 0) == -1) {
+            LOG_ERROR("Could not write to file! Error %d: %s\n", errno, strerror(errno));
+        }
+    }
+
+};
+
+/**
+ * @brief Writes the buffer of the thread m_oIoBatching.m_uVectors times with a single pwritev
+ */
+struct VectoredWriteKernel {
+
+    static inline void run( WriteBenchmark* self, unsigned int thread_num ) {
+        if (pwritev(self->m_pFileDescriptors[thread_num], self->m_pIoVectors + thread_num * self->m_oIoBatching.m_uVectors, self->m_oIoBatching.m_uVectors, 0) == -1) {
+            LOG_ERROR("Could not write to file! Error %d: %s\n", errno, strerror(errno));
+        }
+    }
+
+};
+
+/**
+ * @brief Copies the buffer m_oIoBatching.m_uCoalesce times into the staging
+ * buffer of the thread, as an application would collect its small writes, and
+ * writes them with a single pwrite
+ */
+struct CoalescedWriteKernel {
+
+    static inline void run( WriteBenchmark* self, unsigned int thread_num ) {
+        char* staging = self->m_oStagingBuffers.get(thread_num);
+        const char* buffer = self->m_oBuffers.get(thread_num);
+        const size_t size = self->m_uBufferSize;
+        const unsigned int count = self->m_oIoBatching.m_uCoalesce;
+        for (unsigned int i = 0; i < count; i++) memcpy(staging + i * size, buffer, size);
+        if (pwrite(self->m_pFileDescriptors[thread_num], staging, size * count, 0) == -1) {
+            LOG_ERROR("Could not write to file! Error %d: %s\n", errno, strerror(errno));
+        }
+    }
+
+};
+
+/**
+ * @brief Creates a write benchmark with a kernel that is specialized for the
+ * given buffer size. The sizes of WRITE_BUFFER_SIZES in run.sh and the single
+ * byte writes get their own kernel, all other sizes use the generic one. The
+ * vectored and coalesced variants of the batching use their own kernels
+ *
+ * @param buffer_size The amount of bytes to write per buffer
+ * @param batching The buffers written per system call
+ * @return The benchmark, must be deleted by the caller
+ */
+static inline WriteBenchmark* create_write_benchmark( size_t buffer_size, const IoBatching &batching = IoBatching() ) {
+    WriteBenchmark* benchmark;
+    if (batching.m_uVectors > 1) benchmark = new KernelBenchmark<VectoredWriteKernel, WriteBenchmark>();
+    else if (batching.m_uCoalesce > 1) benchmark = new KernelBenchmark<CoalescedWriteKernel, WriteBenchmark>();
+    else switch (buffer_size) {
+        case 1: benchmark = new KernelBenchmark<WriteKernel<1>, WriteBenchmark>(); break;
+        case 1024: benchmark = new KernelBenchmark<WriteKernel<1024>, WriteBenchmark>(); break;
+        case 2048: benchmark = new KernelBenchmark<WriteKernel<2048>, WriteBenchmark>(); break;
+        case 4096: benchmark = new KernelBenchmark<WriteKernel<4096>, WriteBenchmark>(); break;
+        case 8192: benchmark = new KernelBenchmark<WriteKernel<8192>, WriteBenchmark>(); break;
+        case 65536: benchmark = new KernelBenchmark<WriteKernel<65536>, WriteBenchmark>(); break;
+        default: benchmark = new KernelBenchmark<WriteKernel<0>, WriteBenchmark>(); break;
+    }
+    benchmark->m_uBufferSize = buffer_size;
+    benchmark->m_oIoBatching = batching;
+    return benchmark;
+}
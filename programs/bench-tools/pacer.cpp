@@ -0,0 +1,86 @@
+#include "./pacer.h"
+#include "./benchmark.h"
+
+#include <time.h>
+#include <errno.h>
+
+// the amount of sleeps and the time slept by each of them to measure the wake-up latency
+#define PACER_CALIBRATION_RUNS 100
+#define PACER_CALIBRATION_SLEEP_MICROSECONDS 200
+
+bool Pacer::m_bCalibrated = false;
+double Pacer::m_dWakeupLatencyMedian = 0.0;
+double Pacer::m_dWakeupLatencyP99 = 0.0;
+
+void Pacer::sleep_until( uint64_t deadline ) {
+    struct timespec t;
+    uint64_t nanos;
+
+    // the ticks of the TSC have no fixed relation to CLOCK_MONOTONIC, thus the
+    // remaining time gets added to the current CLOCK_MONOTONIC time
+    if (Clock::m_eSource == ClockSource::MONOTONIC) {
+        nanos = deadline;
+    } else {
+        const uint64_t now = Clock::now();
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        nanos = t.tv_sec*1000000000ull + t.tv_nsec;
+        if (deadline > now) nanos += Clock::to_nanos(deadline-now);
+    }
+    t.tv_sec = nanos / 1000000000ull;
+    t.tv_nsec = nanos % 1000000000ull;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, nullptr) == EINTR);
+}
+
+void Pacer::prepare() {
+    if (m_eMode != PacingMode::HYBRID || m_dSpinMicroseconds > 0.0) return;
+    calibrate();
+    m_dSpinMicroseconds = m_dWakeupLatencyP99;
+}
+
+void Pacer::calibrate() {
+    if (m_bCalibrated) return;
+    TRACE_SPAN("pacer calibration");
+
+    // sleep with a pure absolute deadline and record how late the thread wakes up
+    LatencyHistogram latencies;
+    for (unsigned int i = 0; i < PACER_CALIBRATION_RUNS; i++) {
+        const uint64_t deadline = Clock::now() + Clock::from_micros(PACER_CALIBRATION_SLEEP_MICROSECONDS);
+        sleep_until(deadline);
+        const uint64_t now = Clock::now();
+        latencies.record(now > deadline ? Clock::to_nanos(now-deadline) : 0);
+    }
+    m_dWakeupLatencyMedian = latencies.get_percentile(50.0);
+    m_dWakeupLatencyP99 = latencies.get_percentile(99.0);
+    m_bCalibrated = true;
+    LOG_INFO("Waking up from a sleep takes %.2fus (median), %.2fus (p99)\n", m_dWakeupLatencyMedian, m_dWakeupLatencyP99);
+}
+
+const char* Pacer::get_mode_name() const {
+    switch (m_eMode) {
+        case PacingMode::SLEEP: return "sleep";
+        case PacingMode::SPIN: return "spin";
+        default: return "hybrid";
+    }
+}
+
+void Pacer::to_json( FILE* file ) const {
+    fprintf(file, "{\"mode\": \"%s\"", get_mode_name());
+    if (m_eMode == PacingMode::HYBRID) fprintf(file, ", \"spinMicroseconds\": %.17g", m_dSpinMicroseconds);
+    if (m_bCalibrated) {
+        fprintf(file, ", \"wakeupLatencyMedianMicroseconds\": %.17g", m_dWakeupLatencyMedian);
+        fprintf(file, ", \"wakeupLatencyP99Microseconds\": %.17g", m_dWakeupLatencyP99);
+    }
+    fprintf(file, "}");
+}
+
+void Pacer::process_environment_variables( Pacer* pacer ) {
+    if (pacer == nullptr) return;
+
+    // sleep, spin or hybrid (sleep and spin the wake-up latency), unset keeps the mode of the routine
+    const auto mode = get_config("BM_PACING", std::string(pacer->get_mode_name()));
+    pacer->m_eMode = mode == "sleep" ? PacingMode::SLEEP : mode == "spin" ? PacingMode::SPIN : PacingMode::HYBRID;
+
+    // the spin time of the hybrid mode in microseconds, 0 calibrates it
+    pacer->m_dSpinMicroseconds = get_config("BM_PACING_SPIN", (double)0.0);
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "./clock.h"
+#include "./histogram.h"
+
+enum class PacingMode {
+    SLEEP,      // sleeps until the deadline, keeps the CPU idle in between
+    SPIN,       // busy-waits until the deadline
+    HYBRID      // sleeps until shortly before the deadline and spins the rest
+};
+
+/**
+ * @brief Waits for absolute deadlines in clock ticks. The sleep uses
+ * clock_nanosleep(TIMER_ABSTIME), so an overshoot does not shift the following
+ * deadlines. The wake-up latency of the sleep (an expensive exit in most
+ * enclave runtimes) gets measured once per process, the hybrid mode spins for
+ * its 99th percentile before every deadline
+ */
+class Pacer {
+
+    private:
+
+        // gets set to true once calibrate() was executed
+        static bool m_bCalibrated;
+
+        /**
+         * @brief Sleeps until the given time in clock ticks
+         */
+        static void sleep_until( uint64_t deadline );
+
+    public:
+
+        // the median and the 99th percentile of the wake-up latency in microseconds
+        static double m_dWakeupLatencyMedian;
+        static double m_dWakeupLatencyP99;
+
+        // how to wait for the deadlines
+        PacingMode m_eMode = PacingMode::HYBRID;
+
+        // the time before the deadline at which the hybrid mode starts spinning in
+        // microseconds. 0 uses the calibrated wake-up latency
+        double m_dSpinMicroseconds = 0.0;
+
+        /**
+         * @brief Measures the wake-up latency of the sleep if the hybrid mode needs
+         * it and sets the spin time. Must be called before the timed region
+         */
+        void prepare();
+
+        /**
+         * @brief Measures the wake-up latency of the sleep, only the first call has an effect
+         */
+        static void calibrate();
+
+        /**
+         * @brief Waits until the given time in clock ticks, returns right away if it passed already
+         *
+         * @param deadline The time to wait for as returned by Clock::now()
+         * @param errors [OUT]: The histogram to record how late the wait returned into.
+         * Nothing is recorded if nullptr
+         */
+        inline void wait_until( uint64_t deadline, LatencyHistogram* errors = nullptr ) const;
+
+        /**
+         * @brief Returns the name of the pacing mode as written into the results
+         */
+        const char* get_mode_name() const;
+
+        /**
+         * @brief Writes the pacing mode and the calibration as JSON object
+         *
+         * @param file The file to write the pacer into
+         */
+        void to_json( FILE* file ) const;
+
+        /**
+         * @brief Checks the environment variables for matching parameters
+         *
+         * @param pacer [OUT]: The pacing mode and the spin time, the mode is
+         * kept if BM_PACING is not set
+         */
+        static void process_environment_variables( Pacer* pacer );
+
+};
+
+inline void Pacer::wait_until( uint64_t deadline, LatencyHistogram* errors ) const {
+    if (m_eMode != PacingMode::SPIN) {
+        const uint64_t spin_ticks = m_eMode == PacingMode::HYBRID ? Clock::from_micros(m_dSpinMicroseconds) : 0;
+        if (deadline > spin_ticks && Clock::now() < deadline-spin_ticks) sleep_until(deadline-spin_ticks);
+    }
+    uint64_t now = Clock::now();
+    if (m_eMode != PacingMode::SLEEP) {
+        while (now < deadline) {
+            __asm__ __volatile__( "pause" : : : "memory" );
+            now = Clock::now();
+        }
+    }
+    if (errors != nullptr) errors->record(now > deadline ? Clock::to_nanos(now-deadline) : 0);
+}
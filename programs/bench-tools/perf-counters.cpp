@@ -0,0 +1,139 @@
+#include "./perf-counters.h"
+#include "./benchmark.h"
+
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define PERF_CACHE_CONFIG(cache, op, result) ((cache) | ((op) << 8) | ((result) << 16))
+
+const std::vector<PerfEvent> PerfCounters::EVENTS = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"llcMisses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"dtlbMisses", PERF_TYPE_HW_CACHE, PERF_CACHE_CONFIG(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"contextSwitches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {"cpuMigrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS},
+    {"pageFaults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}
+};
+
+static inline bool is_software( const PerfEvent &event ) {
+    return event.type == PERF_TYPE_SOFTWARE;
+}
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+int PerfCounters::open_event( const PerfEvent &event, pid_t tid, int group_fd, bool user_only ) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = user_only ? 1 : 0;
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, tid, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+void PerfCounters::probe( pid_t tid ) {
+    m_aLive.assign(EVENTS.size(), false);
+    m_aUserOnly.assign(EVENTS.size(), false);
+    for (unsigned int e = 0; e < EVENTS.size(); e++) {
+        int fd = open_event(EVENTS[e], tid, -1, false);
+        if (fd == -1 && (errno == EACCES || errno == EPERM)) {
+            fd = open_event(EVENTS[e], tid, -1, true);
+            m_aUserOnly[e] = fd != -1;
+        }
+        if (fd == -1) {
+            LOG_WARN("Could not open perf counter \"%s\"! Error %d: %s\n", EVENTS[e].name, errno, strerror(errno));
+            continue;
+        }
+        ::close(fd);
+        m_aLive[e] = true;
+    }
+    m_bProbed = true;
+}
+
+void PerfCounters::open( const std::vector<pid_t> &tids ) {
+    if (!m_bEnabled || tids.empty()) return;
+    if (!m_bProbed) probe(tids[0]);
+
+    for (unsigned int i = 0; i < tids.size(); i++) {
+        if (std::find(m_aThreadIds.begin(), m_aThreadIds.end(), tids[i]) != m_aThreadIds.end()) continue;
+        std::vector<int> fds(EVENTS.size(), -1);
+        int hardware_leader = -1, software_leader = -1;
+
+        // the first event of a group that can be opened becomes its leader
+        for (unsigned int e = 0; e < EVENTS.size(); e++) {
+            if (!m_aLive[e]) continue;
+            int &leader = is_software(EVENTS[e]) ? software_leader : hardware_leader;
+            fds[e] = open_event(EVENTS[e], tids[i], leader, m_aUserOnly[e]);
+            if (fds[e] == -1) {
+                LOG_WARN("Could not open perf counter \"%s\" for thread %d! Error %d: %s\n", EVENTS[e].name, tids[i], errno, strerror(errno));
+                continue;
+            }
+            if (leader == -1) leader = fds[e];
+        }
+
+        m_aThreadIds.push_back(tids[i]);
+        m_aFds.push_back(fds);
+        m_aHardwareLeaders.push_back(hardware_leader);
+        m_aSoftwareLeaders.push_back(software_leader);
+    }
+}
+
+void PerfCounters::close() {
+    for (unsigned int i = 0; i < m_aFds.size(); i++) {
+        for (unsigned int e = 0; e < m_aFds[i].size(); e++) if (m_aFds[i][e] != -1) ::close(m_aFds[i][e]);
+    }
+    m_aThreadIds.clear();
+    m_aFds.clear();
+    m_aHardwareLeaders.clear();
+    m_aSoftwareLeaders.clear();
+}
+
+bool PerfCounters::read_group( unsigned int thread, int leader, std::vector<double>* counts ) {
+    uint64_t values[3 + 16];
+    if (leader == -1) return false;
+    const ssize_t n = ::read(leader, values, sizeof(values));
+    if (n < (ssize_t)(3*sizeof(uint64_t))) return false;
+
+    // scale the counts if the group was multiplexed
+    const double scale = values[2] == 0 ? 0.0 : (double)values[1] / values[2];
+    const bool software = m_aSoftwareLeaders[thread] == leader;
+    unsigned int k = 0;
+    for (unsigned int e = 0; e < EVENTS.size() && k < values[0]; e++) {
+        if (is_software(EVENTS[e]) != software || m_aFds[thread][e] == -1) continue;
+        (*counts)[e] += values[3+k] * scale;
+        k++;
+    }
+    return true;
+}
+
+void PerfCounters::read( const std::vector<pid_t> &tids, std::vector<double>* counts ) {
+    counts->assign(EVENTS.size(), 0.0);
+    if (!m_bEnabled) return;
+    for (unsigned int i = 0; i < tids.size(); i++) {
+        const auto it = std::find(m_aThreadIds.begin(), m_aThreadIds.end(), tids[i]);
+        if (it == m_aThreadIds.end()) continue;
+        const unsigned int thread = it - m_aThreadIds.begin();
+        read_group(thread, m_aHardwareLeaders[thread], counts);
+        read_group(thread, m_aSoftwareLeaders[thread], counts);
+    }
+}
+
+std::vector<std::string> PerfCounters::get_live_names() const {
+    std::vector<std::string> names;
+    for (unsigned int e = 0; e < m_aLive.size(); e++) {
+        if (m_aLive[e]) names.push_back(std::string(EVENTS[e].name) + (m_aUserOnly[e] ? ":u" : ""));
+    }
+    return names;
+}
+
+bool PerfCounters::is_live( unsigned int event ) const {
+    return event < m_aLive.size() && m_aLive[event];
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief An event that can be counted with perf_event_open
+ */
+struct PerfEvent {
+
+    // the name used in the results
+    const char* name;
+
+    // the type and config of perf_event_attr
+    uint32_t type;
+    uint64_t config;
+
+};
+
+/**
+ * @brief Counts hardware and software events of the benchmark threads with
+ * perf_event_open. Every thread gets one group for the hardware events and one
+ * for the software events, so a hardware group that cannot be scheduled does
+ * not stop the software events. Events that cannot be opened, e.g. because of
+ * perf_event_paranoid or in a VM, are left out. If the kernel must not be
+ * counted, the event is counted in user space only
+ */
+class PerfCounters {
+
+    protected:
+
+        // gets set to true once the available events were probed
+        bool m_bProbed = false;
+
+        // true for every event that could be opened
+        std::vector<bool> m_aLive;
+
+        // true for every event that only counts in user space
+        std::vector<bool> m_aUserOnly;
+
+        // the threads with open counters
+        std::vector<pid_t> m_aThreadIds;
+
+        // the open file of every event of every thread, -1 if not live
+        std::vector<std::vector<int>> m_aFds;
+
+        // the group leader of the hardware and software events of every thread
+        std::vector<int> m_aHardwareLeaders;
+        std::vector<int> m_aSoftwareLeaders;
+
+        /**
+         * @brief Opens a single event for the given thread
+         *
+         * @return The file descriptor or -1 on error
+         */
+        static int open_event( const PerfEvent &event, pid_t tid, int group_fd, bool user_only );
+
+        /**
+         * @brief Finds out which events can be opened for the given thread
+         */
+        void probe( pid_t tid );
+
+        /**
+         * @brief Reads a group and adds its scaled values to counts
+         *
+         * @return False if the group could not be read
+         */
+        bool read_group( unsigned int thread, int leader, std::vector<double>* counts );
+
+    public:
+
+        // the events to count
+        static const std::vector<PerfEvent> EVENTS;
+
+        // if false, no counters are opened
+        bool m_bEnabled = false;
+
+        PerfCounters() {}
+        PerfCounters( const PerfCounters& ) = delete;
+        PerfCounters& operator=( const PerfCounters& ) = delete;
+        ~PerfCounters();
+
+        /**
+         * @brief Opens the counters of all given threads that have none yet
+         *
+         * @param tids The kernel thread ids of the threads to count
+         */
+        void open( const std::vector<pid_t> &tids );
+
+        /**
+         * @brief Closes all counters
+         */
+        void close();
+
+        /**
+         * @brief Reads the summed up counts of the given threads
+         *
+         * @param tids The kernel thread ids of the threads to read
+         * @param counts [OUT]: The count of every event, 0 if not live
+         */
+        void read( const std::vector<pid_t> &tids, std::vector<double>* counts );
+
+        /**
+         * @brief Returns the names of all live events. Events that only count
+         * in user space get the suffix ":u"
+         */
+        std::vector<std::string> get_live_names() const;
+
+        /**
+         * @brief Returns true if the event with the given index is live
+         */
+        bool is_live( unsigned int event ) const;
+
+};
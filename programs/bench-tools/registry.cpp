@@ -0,0 +1,66 @@
+#include "./registry.h"
+#include "./benchmark.h"
+
+#include <string.h>
+#include <fnmatch.h>
+#include <algorithm>
+
+const char* RoutineRegistry::m_pCurrent = nullptr;
+
+std::vector<Routine>& RoutineRegistry::get_routines() {
+    static std::vector<Routine> routines;
+    return routines;
+}
+
+bool RoutineRegistry::add( const char* name, routine_main_t main ) {
+    auto &routines = get_routines();
+    auto it = routines.begin();
+    while (it != routines.end() && strcmp(it->name, name) < 0) it++;
+    routines.insert(it, {name, main});
+    return true;
+}
+
+std::vector<const Routine*> RoutineRegistry::find( const std::string &patterns ) {
+    std::vector<const Routine*> res;
+    size_t begin = 0;
+    while (begin <= patterns.size()) {
+        size_t end = patterns.find(',', begin);
+        if (end == std::string::npos) end = patterns.size();
+        const std::string pattern = patterns.substr(begin, end-begin);
+        bool found = false;
+        for (const auto &routine : get_routines()) {
+            if (pattern.empty() || fnmatch(pattern.c_str(), routine.name, 0) != 0) continue;
+            found = true;
+            if (std::find(res.begin(), res.end(), &routine) == res.end()) res.push_back(&routine);
+        }
+        if (!found && !pattern.empty()) LOG_WARN("No routine matches \"%s\"!\n", pattern.c_str());
+        begin = end+1;
+    }
+    return res;
+}
+
+int RoutineRegistry::run( const std::string &patterns, int argc, char **argv, char **envp ) {
+    const auto routines = find(patterns);
+    int res = 0;
+    if (routines.empty()) {
+        LOG_ERROR("No routines to run!\n");
+        return 1;
+    }
+    for (unsigned int i = 0; i < routines.size(); i++) {
+        LOG_INFO("Running routine \"%s\" (%u of %lu)...\n", routines[i]->name, i+1, (unsigned long)routines.size());
+        m_pCurrent = routines[i]->name;
+        const int status = Sweep::run(routines[i]->main, argc, argv, envp);
+        if (status != 0) {
+            LOG_ERROR("Routine \"%s\" failed with status %d!\n", routines[i]->name, status);
+            res = status;
+        }
+    }
+    m_pCurrent = nullptr;
+    return res;
+}
+
+std::string expand_routine_path( const std::string &path ) {
+    const size_t position = path.find(ROUTINE_PLACEHOLDER);
+    if (RoutineRegistry::m_pCurrent == nullptr || position == std::string::npos) return path;
+    return path.substr(0, position) + RoutineRegistry::m_pCurrent + path.substr(position+strlen(ROUTINE_PLACEHOLDER));
+}
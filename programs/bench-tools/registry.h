@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// the placeholder in result file paths that gets replaced with the name of the running routine
+#define ROUTINE_PLACEHOLDER "{routine}"
+
+typedef int (*routine_main_t)( int argc, char **argv, char **envp );
+
+/**
+ * @brief Declares the entry point of a benchmark routine. In the single bench
+ * binary (BENCH_SINGLE_BINARY) the routine registers itself under the given
+ * name, otherwise the main function of the routine's own binary runs it. Both
+ * run it once per point of the configured Sweep
+ */
+#ifdef BENCH_SINGLE_BINARY
+#define BENCH_ROUTINE(name) \
+    static int bench_routine_main( int argc, char **argv, char **envp ); \
+    static const bool bench_routine_registered __attribute__((unused)) = RoutineRegistry::add(name, bench_routine_main); \
+    static int bench_routine_main( int argc, char **argv, char **envp )
+#else
+#define BENCH_ROUTINE(name) \
+    static int bench_routine_main( int argc, char **argv, char **envp ); \
+    int main( int argc, char **argv, char **envp ) { return Sweep::run(bench_routine_main, argc, argv, envp); } \
+    static int bench_routine_main( int argc, char **argv, char **envp )
+#endif
+
+/**
+ * @brief A registered benchmark routine
+ */
+struct Routine {
+
+    // the name to select the routine with, the directory name of the routine
+    const char* name;
+
+    // the entry point of the routine
+    routine_main_t main;
+
+};
+
+/**
+ * @brief All routines linked into the bench binary. The routines register
+ * themselves during static initialization, so the registry lives in a function
+ * local static to not depend on the initialization order of the translation units
+ */
+class RoutineRegistry {
+
+    public:
+
+        // the name of the running routine, nullptr outside of the bench binary
+        static const char* m_pCurrent;
+
+        /**
+         * @brief Returns all registered routines sorted by name
+         */
+        static std::vector<Routine>& get_routines();
+
+        /**
+         * @brief Registers a routine, used by BENCH_ROUTINE
+         *
+         * @returns always true
+         */
+        static bool add( const char* name, routine_main_t main );
+
+        /**
+         * @brief Returns the routines matching any of the comma separated
+         * glob patterns, e.g. "write*,read", in the order of the patterns
+         */
+        static std::vector<const Routine*> find( const std::string &patterns );
+
+        /**
+         * @brief Runs the routines matching the given patterns one after another
+         * in this process, each once per point of the configured Sweep
+         *
+         * @returns 0 if all routines succeeded
+         */
+        static int run( const std::string &patterns, int argc, char **argv, char **envp );
+
+};
+
+/**
+ * @brief Replaces ROUTINE_PLACEHOLDER in the given path with the name of the
+ * running routine
+ */
+std::string expand_routine_path( const std::string &path );
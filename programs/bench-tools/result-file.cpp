@@ -0,0 +1,223 @@
+#include "./result-file.h"
+#include "./benchmark.h"
+
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+extern char** environ;
+
+std::string ResultWriter::m_sFilepath;
+
+static inline size_t pad8( size_t size ) {
+    return (size + 7) & ~(size_t)7;
+}
+
+std::string to_json_string( const std::string &s ) {
+    std::string res = "\"";
+    char escaped[8];
+    for (const char c : s) {
+        switch (c) {
+            case '"': res += "\\\""; break;
+            case '\\': res += "\\\\"; break;
+            case '\n': res += "\\n"; break;
+            case '\t': res += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    res += escaped;
+                } else {
+                    res += c;
+                }
+        }
+    }
+    return res + "\"";
+}
+
+ResultWriter::~ResultWriter() {
+    close();
+}
+
+void ResultWriter::add_chunk( const char* name, uint16_t type, uint32_t index, uint32_t count, const void* data, size_t size ) {
+    static const char ZEROS[8] = {0};
+    const size_t name_length = strlen(name);
+    ResultChunkHeader header;
+    header.magic = RESULT_CHUNK_MAGIC;
+    header.type = type;
+    header.name_length = name_length;
+    header.index = index;
+    header.count = count;
+    header.size = pad8(name_length) + pad8(size);
+    m_sPending.append((const char*)&header, sizeof(header));
+    m_sPending.append(name, name_length);
+    m_sPending.append(ZEROS, pad8(name_length)-name_length);
+    m_sPending.append((const char*)data, size);
+    m_sPending.append(ZEROS, pad8(size)-size);
+}
+
+bool ResultWriter::open( const char* type ) {
+    if (m_sFilepath.empty()) return false;
+    close();
+    if ((m_iFd = ::open(m_sFilepath.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_APPEND, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH)) == -1) {
+        LOG_ERROR("Could not open result file at \"%s\". Error %d: %s\n", m_sFilepath.c_str(), errno, strerror(errno));
+        return false;
+    }
+
+    ResultFileHeader header;
+    memcpy(header.magic, RESULT_FILE_MAGIC, sizeof(header.magic));
+    header.version = RESULT_FILE_VERSION;
+    header.byte_order = 0x01020304;
+    m_sPending.assign((const char*)&header, sizeof(header));
+    add_string("type", RESULT_RUN_INDEX, type);
+    add_json("config", RESULT_RUN_INDEX, Config::to_json());
+    if (!Config::m_aUnknownKeys.empty()) add_json("unknownConfigKeys", RESULT_RUN_INDEX, Config::unknown_keys_to_json());
+    const std::string environment = environment_variables_to_json_array(environ);
+    add_json("environmentVariables", RESULT_RUN_INDEX, environment.substr(environment.find('[')));
+    flush();
+    return is_open();
+}
+
+void ResultWriter::add( const char* name, uint32_t index, double value ) {
+    add_chunk(name, RESULT_F64, index, 1, &value, sizeof(value));
+}
+
+void ResultWriter::add( const char* name, uint32_t index, int64_t value ) {
+    add_chunk(name, RESULT_I64, index, 1, &value, sizeof(value));
+}
+
+void ResultWriter::add( const char* name, uint32_t index, const std::vector<double> &values ) {
+    add_chunk(name, RESULT_F64|RESULT_ARRAY, index, values.size(), values.data(), values.size()*sizeof(double));
+}
+
+void ResultWriter::add( const char* name, uint32_t index, const std::vector<int64_t> &values ) {
+    add_chunk(name, RESULT_I64|RESULT_ARRAY, index, values.size(), values.data(), values.size()*sizeof(int64_t));
+}
+
+void ResultWriter::add_string( const char* name, uint32_t index, const std::string &value ) {
+    add_chunk(name, RESULT_STRING, index, value.size(), value.data(), value.size());
+}
+
+void ResultWriter::add_json( const char* name, uint32_t index, const std::string &json ) {
+    add_chunk(name, RESULT_JSON, index, json.size(), json.data(), json.size());
+}
+
+void ResultWriter::add_json( const char* name, uint32_t index, const std::function<void(FILE*)> &to_json ) {
+    char* buffer = nullptr;
+    size_t size = 0;
+    FILE* file = open_memstream(&buffer, &size);
+    if (file == nullptr) {
+        LOG_ERROR("Could not create memory stream for column \"%s\". Error %d: %s\n", name, errno, strerror(errno));
+        return;
+    }
+    to_json(file);
+    fclose(file);
+    add_chunk(name, RESULT_JSON, index, size, buffer, size);
+    free(buffer);
+}
+
+void ResultWriter::flush() {
+    if (!is_open() || m_sPending.empty()) return;
+
+    // one write per flush, so a crash only loses the chunks of the current batch
+    size_t written = 0;
+    while (written < m_sPending.size()) {
+        const ssize_t n = ::write(m_iFd, m_sPending.data()+written, m_sPending.size()-written);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) {
+            LOG_ERROR("Could not write to result file at \"%s\". Error %d: %s\n", m_sFilepath.c_str(), errno, strerror(errno));
+            ::close(m_iFd);
+            m_iFd = -1;
+            break;
+        }
+        written += n;
+    }
+    m_sPending.clear();
+}
+
+void ResultWriter::close() {
+    if (!is_open()) return;
+    flush();
+    if (is_open()) ::close(m_iFd);
+    m_iFd = -1;
+}
+
+void ResultWriter::process_environment_variables() {
+
+    // the file to write the binary results into while the benchmark runs
+    m_sFilepath = expand_routine_path(get_config("BM_RESULT_FILEPATH"));
+
+}
+
+ResultReader::~ResultReader() {
+    close();
+}
+
+bool ResultReader::open( const char* path ) {
+    struct stat info;
+    close();
+    const int fd = ::open(path, O_RDONLY);
+    if (fd == -1) {
+        LOG_ERROR("Could not open result file at \"%s\". Error %d: %s\n", path, errno, strerror(errno));
+        return false;
+    }
+    if (fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(ResultFileHeader)) {
+        LOG_ERROR("\"%s\" is no result file!\n", path);
+        ::close(fd);
+        return false;
+    }
+    m_uSize = info.st_size;
+    m_pMap = mmap(nullptr, m_uSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m_pMap == MAP_FAILED) {
+        LOG_ERROR("Could not map result file at \"%s\". Error %d: %s\n", path, errno, strerror(errno));
+        m_pMap = nullptr;
+        return false;
+    }
+
+    // check the header
+    const char* data = (const char*)m_pMap;
+    const ResultFileHeader* header = (const ResultFileHeader*)data;
+    if (memcmp(header->magic, RESULT_FILE_MAGIC, sizeof(header->magic)) != 0 || header->byte_order != 0x01020304) {
+        LOG_ERROR("\"%s\" is no result file or was written on a machine with a different byte order!\n", path);
+        close();
+        return false;
+    }
+    m_uVersion = header->version;
+    if (m_uVersion > RESULT_FILE_VERSION) {
+        LOG_ERROR("\"%s\" has version %u, but only versions up to %u are supported!\n", path, m_uVersion, RESULT_FILE_VERSION);
+        close();
+        return false;
+    }
+
+    // split the chunks
+    size_t offset = sizeof(ResultFileHeader);
+    while (offset < m_uSize) {
+        const ResultChunkHeader* chunk_header = (const ResultChunkHeader*)(data+offset);
+        if (m_uSize-offset < sizeof(ResultChunkHeader) || chunk_header->magic != RESULT_CHUNK_MAGIC || chunk_header->size > m_uSize-offset-sizeof(ResultChunkHeader)) {
+            m_bTruncated = true;
+            break;
+        }
+        ResultChunk chunk;
+        const char* name = data + offset + sizeof(ResultChunkHeader);
+        chunk.name.assign(name, chunk_header->name_length);
+        chunk.type = chunk_header->type;
+        chunk.index = chunk_header->index;
+        chunk.count = chunk_header->count;
+        chunk.data = name + pad8(chunk_header->name_length);
+        m_aChunks.push_back(chunk);
+        offset += sizeof(ResultChunkHeader) + chunk_header->size;
+    }
+    return true;
+}
+
+void ResultReader::close() {
+    if (m_pMap != nullptr) munmap(m_pMap, m_uSize);
+    m_pMap = nullptr;
+    m_uSize = 0;
+    m_uVersion = 0;
+    m_bTruncated = false;
+    m_aChunks.clear();
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+// the first bytes of every result file
+#define RESULT_FILE_MAGIC "BMRESULT"
+
+// the version of the layout below, increment on incompatible changes
+#define RESULT_FILE_VERSION 1
+
+// the first bytes of every chunk ("CHNK" in little endian)
+#define RESULT_CHUNK_MAGIC 0x4b4e4843
+
+// the index of columns that describe the whole run instead of a single batch
+#define RESULT_RUN_INDEX UINT32_MAX
+
+// marks a column whose values are arrays instead of scalars
+#define RESULT_ARRAY 0x100
+
+/**
+ * @brief The type of the values of a column
+ */
+enum ResultColumnType : uint16_t {
+
+    // 64 bit floats
+    RESULT_F64 = 1,
+
+    // 64 bit signed integers
+    RESULT_I64 = 2,
+
+    // a string, count is the amount of bytes
+    RESULT_STRING = 3,
+
+    // a JSON value, count is the amount of bytes
+    RESULT_JSON = 4
+
+};
+
+/**
+ * @brief The start of a result file
+ */
+struct ResultFileHeader {
+
+    // RESULT_FILE_MAGIC without the terminating zero
+    char magic[8];
+
+    // RESULT_FILE_VERSION
+    uint32_t version;
+
+    // 0x01020304 in the byte order of the writer
+    uint32_t byte_order;
+
+};
+
+/**
+ * @brief The start of a chunk. It is followed by the column name and the
+ * values, both padded to 8 bytes, so the values of a mapped file are aligned
+ */
+struct ResultChunkHeader {
+
+    // RESULT_CHUNK_MAGIC
+    uint32_t magic;
+
+    // a ResultColumnType, optionally combined with RESULT_ARRAY
+    uint16_t type;
+
+    // the length of the column name
+    uint16_t name_length;
+
+    // the batch (or sample) the values belong to or RESULT_RUN_INDEX
+    uint32_t index;
+
+    // the amount of values, or bytes for strings and JSON
+    uint32_t count;
+
+    // the size of the padded name and values after this header
+    uint64_t size;
+
+};
+
+/**
+ * @brief A chunk of a mapped result file
+ */
+struct ResultChunk {
+
+    // the column name, not zero terminated
+    std::string name;
+
+    // a ResultColumnType, optionally combined with RESULT_ARRAY
+    uint16_t type;
+
+    // the batch (or sample) the values belong to or RESULT_RUN_INDEX
+    uint32_t index;
+
+    // the amount of values, or bytes for strings and JSON
+    uint32_t count;
+
+    // the values inside the mapped file
+    const void* data;
+
+};
+
+/**
+ * @brief Returns the given string as quoted and escaped JSON string
+ */
+std::string to_json_string( const std::string &s );
+
+/**
+ * @brief Writes results as typed column chunks. Chunks are collected in
+ * memory and appended to the file by flush(), so the results of every
+ * completed batch survive a crash of the benchmark
+ */
+class ResultWriter {
+
+    protected:
+
+        // the result file, -1 if closed
+        int m_iFd = -1;
+
+        // the chunks that are not written yet
+        std::string m_sPending;
+
+        /**
+         * @brief Appends a chunk to m_sPending
+         */
+        void add_chunk( const char* name, uint16_t type, uint32_t index, uint32_t count, const void* data, size_t size );
+
+    public:
+
+        // the file to write the results into, empty disables the result file
+        static std::string m_sFilepath;
+
+        ResultWriter() {}
+        ResultWriter( const ResultWriter& ) = delete;
+        ResultWriter& operator=( const ResultWriter& ) = delete;
+        ~ResultWriter();
+
+        /**
+         * @brief Creates the result file at m_sFilepath and writes the header
+         * with the result type, the config and the SCONE environment variables
+         *
+         * @param type The type of the results, e.g. "TROUGHPUT-BENCHMARK"
+         * @returns false if no result file is configured or it could not be created
+         */
+        bool open( const char* type );
+
+        /**
+         * @brief Returns true if the result file is open
+         */
+        inline bool is_open() const {
+            return m_iFd != -1;
+        }
+
+        /**
+         * @brief Adds a value or an array of values to a column
+         *
+         * @param name The column name. "a.b" becomes the field b of the object a
+         * and "a[].b" the field b of the objects in the array a
+         * @param index The batch (or sample) or RESULT_RUN_INDEX
+         */
+        void add( const char* name, uint32_t index, double value );
+        void add( const char* name, uint32_t index, int64_t value );
+        void add( const char* name, uint32_t index, const std::vector<double> &values );
+        void add( const char* name, uint32_t index, const std::vector<int64_t> &values );
+        void add_string( const char* name, uint32_t index, const std::string &value );
+
+        /**
+         * @brief Adds a JSON value to a column
+         *
+         * @param to_json Writes the JSON value into the given file
+         */
+        void add_json( const char* name, uint32_t index, const std::string &json );
+        void add_json( const char* name, uint32_t index, const std::function<void(FILE*)> &to_json );
+
+        /**
+         * @brief Appends the pending chunks to the file
+         */
+        void flush();
+
+        /**
+         * @brief Flushes and closes the file
+         */
+        void close();
+
+        /**
+         * @brief Checks the environment variables. BM_RESULT_FILEPATH sets the
+         * result file
+         */
+        static void process_environment_variables();
+
+};
+
+/**
+ * @brief Maps a result file and splits it into its chunks. A truncated
+ * last chunk, e.g. after a crash while writing, is ignored
+ */
+class ResultReader {
+
+    protected:
+
+        // the mapped file
+        void* m_pMap = nullptr;
+        size_t m_uSize = 0;
+
+    public:
+
+        // the version of the file
+        uint32_t m_uVersion = 0;
+
+        // true if the file ends with a truncated chunk
+        bool m_bTruncated = false;
+
+        // the chunks in the order they were written
+        std::vector<ResultChunk> m_aChunks;
+
+        ResultReader() {}
+        ResultReader( const ResultReader& ) = delete;
+        ResultReader& operator=( const ResultReader& ) = delete;
+        ~ResultReader();
+
+        /**
+         * @brief Maps the given file and parses its chunks
+         *
+         * @returns false if the file could not be mapped or is no result file
+         */
+        bool open( const char* path );
+
+        /**
+         * @brief Unmaps the file
+         */
+        void close();
+
+};
@@ -0,0 +1,114 @@
+#include "./scaling.h"
+#include "./benchmark.h"
+
+#include <thread>
+
+ThreadScaling* ThreadScaling::m_pActive = nullptr;
+
+std::string ThreadScaling::get_sweep_grid() const {
+    std::string res = "BM_NUM_THREADS=";
+    for (unsigned int i = 0; i < m_aThreadCounts.size(); i++) res += (i == 0 ? "" : ",") + std::to_string(m_aThreadCounts[i]);
+    return res;
+}
+
+void ThreadScaling::begin_step( unsigned int num_threads ) {
+    ScalingStep step;
+    step.num_threads = num_threads;
+    m_aSteps.push_back(step);
+}
+
+void ThreadScaling::record( const Batch &batch ) {
+    if (m_pActive == nullptr || m_pActive->m_aSteps.empty() || batch.m_uNumExecutedBatches == 0) return;
+    ScalingStep &step = m_pActive->m_aSteps.back();
+    std::vector<double> ops_per_second, latencies, cpu_times;
+    for (unsigned int i = 0; i < batch.m_uNumExecutedBatches; i++) {
+        const Benchmark &benchmark = batch.m_pBenchmarks[i];
+        const double num_ops = (double)benchmark.m_uNumExecutions * benchmark.m_uNumThreads;
+        if (benchmark.m_dThreadDurationMean > 0.0) ops_per_second.push_back(benchmark.m_uNumThreads * 1e6 / benchmark.m_dThreadDurationMean);
+        latencies.push_back(benchmark.m_dThreadDurationMean);
+        cpu_times.push_back(benchmark.m_dFullCpuTime / num_ops);
+    }
+    step.num_threads = batch.m_pBenchmarks[0].m_uNumThreads;
+    step.ops_per_second = get_median(ops_per_second);
+    step.latency = get_median(latencies);
+    step.cpu_time_per_op = get_median(cpu_times);
+    step.measured = true;
+}
+
+void ThreadScaling::analyze() {
+    int baseline = -1;
+    m_iPeak = m_iCollapse = -1;
+    for (unsigned int i = 0; i < m_aSteps.size(); i++) {
+        if (!m_aSteps[i].measured) continue;
+        if (baseline == -1 || m_aSteps[i].num_threads < m_aSteps[baseline].num_threads) baseline = i;
+        if (m_iPeak == -1 || m_aSteps[i].ops_per_second > m_aSteps[m_iPeak].ops_per_second) m_iPeak = i;
+    }
+    if (baseline == -1) return;
+
+    // efficiency relative to the throughput per thread of the baseline
+    const double baseline_per_thread = m_aSteps[baseline].ops_per_second / m_aSteps[baseline].num_threads;
+    for (auto &step : m_aSteps) {
+        if (step.measured && baseline_per_thread > 0.0) step.efficiency = step.ops_per_second / step.num_threads / baseline_per_thread;
+    }
+
+    // the first step with more threads than the peak that falls below the threshold
+    const ScalingStep &peak = m_aSteps[m_iPeak];
+    for (unsigned int i = 0; i < m_aSteps.size(); i++) {
+        const ScalingStep &step = m_aSteps[i];
+        if (!step.measured || step.num_threads <= peak.num_threads) continue;
+        if (step.ops_per_second < (1.0-m_dCollapseThreshold) * peak.ops_per_second && (m_iCollapse == -1 || step.num_threads < m_aSteps[m_iCollapse].num_threads)) m_iCollapse = i;
+    }
+    LOG_INFO("Throughput peaks at %u thread%s with %.0f calls/s\n", peak.num_threads, peak.num_threads == 1 ? "" : "s", peak.ops_per_second);
+    if (m_iCollapse != -1) {
+        LOG_WARN("Throughput collapses to %.0f calls/s (%.1f%% of the peak) at %u threads!\n", m_aSteps[m_iCollapse].ops_per_second, 100.0*m_aSteps[m_iCollapse].ops_per_second/peak.ops_per_second, m_aSteps[m_iCollapse].num_threads);
+    }
+}
+
+void ThreadScaling::to_json( FILE* file ) const {
+    fprintf(file, "{\"steps\": [");
+    for (unsigned int i = 0; i < m_aSteps.size(); i++) {
+        const ScalingStep &step = m_aSteps[i];
+        if (!step.measured) {
+            fprintf(file, "{\"numThreads\": %u}%s", step.num_threads, i==m_aSteps.size()-1 ? "" : ", ");
+            continue;
+        }
+        fprintf(file, "{\"numThreads\": %u, ", step.num_threads);
+        fprintf(file, "\"callsPerSecond\": %.17g, ", step.ops_per_second);
+        fprintf(file, "\"latencyMicroseconds\": %.17g, ", step.latency);
+        fprintf(file, "\"cpuTimePerCallMicroseconds\": %.17g, ", step.cpu_time_per_op);
+        fprintf(file, "\"efficiency\": %.17g}%s", step.efficiency, i==m_aSteps.size()-1 ? "" : ", ");
+    }
+    fprintf(file, "], ");
+    fprintf(file, "\"collapseThreshold\": %.17g, ", m_dCollapseThreshold);
+    if (m_iPeak == -1) fprintf(file, "\"peakThreads\": null, ");
+    else fprintf(file, "\"peakThreads\": %u, ", m_aSteps[m_iPeak].num_threads);
+    if (m_iCollapse == -1) fprintf(file, "\"collapseThreads\": null}");
+    else fprintf(file, "\"collapseThreads\": %u}", m_aSteps[m_iCollapse].num_threads);
+}
+
+void ThreadScaling::process_environment_variables( ThreadScaling* scaling ) {
+    if (scaling == nullptr) return;
+    scaling->m_aThreadCounts.clear();
+
+    // the thread counts, e.g. "1,2,3,4", "auto" doubles from 1 up to BM_NUM_THREADS. Empty disables the scaling mode
+    const auto counts = get_config("BM_SCALING_THREADS");
+    if (counts == "auto") {
+        const unsigned int max_threads = get_config("BM_NUM_THREADS", (long)std::thread::hardware_concurrency());
+        for (unsigned int n = 1; n < max_threads; n *= 2) scaling->m_aThreadCounts.push_back(n);
+        scaling->m_aThreadCounts.push_back(std::max(max_threads, 1u));
+    } else if (!counts.empty()) {
+        size_t begin = 0;
+        while (begin < counts.size()) {
+            size_t end = counts.find(',', begin);
+            if (end == std::string::npos) end = counts.size();
+            const unsigned long n = strtoul(counts.substr(begin, end-begin).c_str(), nullptr, 10);
+            if (n == 0) LOG_WARN("Ignoring the thread count \"%s\" of the scaling mode\n", counts.substr(begin, end-begin).c_str());
+            else scaling->m_aThreadCounts.push_back(n);
+            begin = end+1;
+        }
+    }
+
+    // the relative drop below the peak throughput that counts as collapse
+    scaling->m_dCollapseThreshold = get_config("BM_SCALING_COLLAPSE", (double)0.2);
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+class Batch;
+
+/**
+ * @brief The outcome of a routine at a single thread count
+ */
+struct ScalingStep {
+
+    unsigned int num_threads = 0;
+
+    // false if the routine did not run a Batch at this thread count
+    bool measured = false;
+
+    // the median over the batches of the calls per second of all threads together,
+    // from the mean runtime of a call, so the start of the threads is not part of it
+    double ops_per_second = 0.0;
+
+    // the median over the batches of the mean runtime of a call in a thread in microseconds
+    double latency = 0.0;
+
+    // the median over the batches of the CPU time per call in microseconds
+    double cpu_time_per_op = 0.0;
+
+    // the throughput per thread relative to the throughput per thread of the baseline
+    double efficiency = 0.0;
+
+};
+
+/**
+ * @brief Runs a routine at several thread counts in one process (as a Sweep
+ * over BM_NUM_THREADS) and derives the scaling curve from the batches. The
+ * step with the fewest threads is the baseline of the parallel efficiency.
+ * A collapse is flagged if the throughput drops by m_dCollapseThreshold
+ * below its peak at a higher thread count
+ */
+class ThreadScaling {
+
+    public:
+
+        // the scaling run the batches report to, nullptr outside of a scaling run
+        static ThreadScaling* m_pActive;
+
+        // the thread counts to run at, empty disables the scaling mode
+        std::vector<unsigned int> m_aThreadCounts;
+
+        // the steps in the order of m_aThreadCounts
+        std::vector<ScalingStep> m_aSteps;
+
+        // the relative drop below the peak throughput that counts as collapse
+        double m_dCollapseThreshold = 0.2;
+
+        // the indices of the peak and of the first collapsed step, -1 if there is none
+        int m_iPeak = -1;
+        int m_iCollapse = -1;
+
+        /**
+         * @brief Returns the grid of the sweep over the thread counts
+         */
+        std::string get_sweep_grid() const;
+
+        /**
+         * @brief Starts the step of the given thread count, the next batch reports to it
+         */
+        void begin_step( unsigned int num_threads );
+
+        /**
+         * @brief Records the executed batches of the given batch as the current
+         * step of the active scaling run, if there is one
+         */
+        static void record( const Batch &batch );
+
+        /**
+         * @brief Computes the efficiencies and finds the peak and the collapse
+         */
+        void analyze();
+
+        /**
+         * @brief Writes the scaling curve as JSON object
+         *
+         * @param file The file to write the scaling curve into
+         */
+        void to_json( FILE* file ) const;
+
+        /**
+         * @brief Checks the environment variables for matching parameters
+         *
+         * @param scaling [OUT]: The thread counts and the collapse threshold
+         */
+        static void process_environment_variables( ThreadScaling* scaling );
+
+};
@@ -0,0 +1,63 @@
+#include "./statistics.h"
+
+#include <math.h>
+#include <random>
+#include <limits>
+#include <algorithm>
+
+double get_median( std::vector<double> values ) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values.size() % 2 == 0 ? (values[values.size()/2]+values[values.size()/2-1]) / 2.0 : values[values.size()/2];
+}
+
+double get_mad( const std::vector<double> &values, double median ) {
+    std::vector<double> deviations;
+    for (const double v : values) deviations.push_back(fabs(v-median));
+    return get_median(deviations);
+}
+
+void BatchStatistics::compute( const std::vector<double> &values ) {
+    m_uNumValues = values.size();
+    m_dMean = m_dMedian = m_dMad = m_dCiLower = m_dCiUpper = 0.0;
+    if (values.empty()) return;
+    for (const double v : values) m_dMean += v;
+    m_dMean /= values.size();
+    m_dMedian = get_median(values);
+    m_dMad = get_mad(values, m_dMedian);
+    if (values.size() < 2 || m_uNumResamples == 0) {
+        m_dCiLower = m_dCiUpper = m_dMean;
+        return;
+    }
+
+    // percentile bootstrap of the mean
+    std::mt19937_64 rng(0x5eed);
+    std::uniform_int_distribution<size_t> pick(0, values.size()-1);
+    std::vector<double> means(m_uNumResamples);
+    for (unsigned int r = 0; r < m_uNumResamples; r++) {
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); i++) sum += values[pick(rng)];
+        means[r] = sum / values.size();
+    }
+    std::sort(means.begin(), means.end());
+    const double alpha = (1.0-m_dConfidenceLevel) / 2.0;
+    m_dCiLower = means[(size_t)floor(alpha*(m_uNumResamples-1))];
+    m_dCiUpper = means[(size_t)ceil((1.0-alpha)*(m_uNumResamples-1))];
+}
+
+double BatchStatistics::get_relative_half_width() const {
+    if (m_dMean == 0.0) return std::numeric_limits<double>::infinity();
+    return (m_dCiUpper-m_dCiLower) / 2.0 / fabs(m_dMean);
+}
+
+void BatchStatistics::to_json( FILE* file ) const {
+    fprintf(file, "{\"numValues\": %u, ", m_uNumValues);
+    fprintf(file, "\"mean\": %.17g, ", m_dMean);
+    fprintf(file, "\"median\": %.17g, ", m_dMedian);
+    fprintf(file, "\"mad\": %.17g, ", m_dMad);
+    fprintf(file, "\"confidenceLevel\": %.17g, ", m_dConfidenceLevel);
+    fprintf(file, "\"ciLower\": %.17g, ", m_dCiLower);
+    fprintf(file, "\"ciUpper\": %.17g, ", m_dCiUpper);
+    if (m_uNumValues < 2 || m_dMean == 0.0) fprintf(file, "\"relativeHalfWidth\": null}");
+    else fprintf(file, "\"relativeHalfWidth\": %.17g}", get_relative_half_width());
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @brief Returns the median of the given values
+ */
+double get_median( std::vector<double> values );
+
+/**
+ * @brief Returns the median absolute deviation of the given values from their median
+ */
+double get_mad( const std::vector<double> &values, double median );
+
+/**
+ * @brief Robust summary of the batch means with a percentile bootstrap
+ * confidence interval of their mean
+ */
+class BatchStatistics {
+
+    public:
+
+        // the confidence level of the interval
+        double m_dConfidenceLevel = 0.95;
+
+        // the amount of bootstrap resamples
+        unsigned int m_uNumResamples = 2000;
+
+        // the amount of values the statistics were computed from
+        unsigned int m_uNumValues = 0;
+
+        // the mean, median and median absolute deviation of the values
+        double m_dMean = 0.0;
+        double m_dMedian = 0.0;
+        double m_dMad = 0.0;
+
+        // the bounds of the confidence interval of the mean
+        double m_dCiLower = 0.0;
+        double m_dCiUpper = 0.0;
+
+        /**
+         * @brief Computes the statistics of the given values. The resamples
+         * use a fixed seed, so the same values always give the same interval
+         */
+        void compute( const std::vector<double> &values );
+
+        /**
+         * @brief Returns the half-width of the confidence interval relative to
+         * the mean, i.e. the achieved precision
+         */
+        double get_relative_half_width() const;
+
+        /**
+         * @brief Writes the statistics as JSON object
+         *
+         * @param file The file to write the statistics into
+         */
+        void to_json( FILE* file ) const;
+
+};
@@ -0,0 +1,180 @@
+#include "./sweep.h"
+#include "./benchmark.h"
+
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fstream>
+
+/**
+ * @brief Splits the string at every separator, empty parts are skipped
+ */
+static std::vector<std::string> split( const std::string &s, char separator ) {
+    std::vector<std::string> res;
+    size_t begin = 0;
+    while (begin <= s.size()) {
+        size_t end = s.find(separator, begin);
+        if (end == std::string::npos) end = s.size();
+        const size_t first = s.find_first_not_of(" \t", begin);
+        if (first < end) res.push_back(s.substr(first, s.find_last_not_of(" \t", end-1)-first+1));
+        begin = end+1;
+    }
+    return res;
+}
+
+bool Sweep::parse( const std::string &grid ) {
+    m_aDimensions.clear();
+    for (const auto &dimension : split(grid, ';')) {
+        const size_t position = dimension.find('=');
+        if (position == std::string::npos) {
+            LOG_ERROR("Invalid sweep dimension \"%s\"! Expected KEY=VALUE,VALUE,...\n", dimension.c_str());
+            return false;
+        }
+        const auto names = split(dimension.substr(0, position), ',');
+        SweepDimension d = {names.empty() ? "" : names[0], split(dimension.substr(position+1), ',')};
+        if (names.size() != 1) {
+            LOG_ERROR("Invalid sweep dimension \"%s\"! Expected a single config key\n", dimension.c_str());
+            return false;
+        }
+        if (d.values.empty()) {
+            LOG_ERROR("The sweep dimension %s has no values!\n", d.name.c_str());
+            return false;
+        }
+        for (const auto &value : d.values) {
+            if (!Config::is_valid(d.name, value)) return false;
+        }
+        m_aDimensions.push_back(d);
+    }
+    if (!m_bCartesian) {
+        for (const auto &d : m_aDimensions) {
+            if (d.values.size() == m_aDimensions[0].values.size()) continue;
+            LOG_ERROR("All dimensions of a listed sweep need the same amount of values, but %s has %lu instead of %lu!\n", d.name.c_str(), (unsigned long)d.values.size(), (unsigned long)m_aDimensions[0].values.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned int Sweep::get_num_points() const {
+    if (m_aDimensions.empty()) return 0;
+    if (!m_bCartesian) return m_aDimensions[0].values.size();
+    unsigned int res = 1;
+    for (const auto &d : m_aDimensions) res *= d.values.size();
+    return res;
+}
+
+std::vector<std::string> Sweep::get_point( unsigned int index ) const {
+    std::vector<std::string> res(m_aDimensions.size());
+    for (int i = m_aDimensions.size()-1; i >= 0; i--) {
+        const auto &values = m_aDimensions[i].values;
+        res[i] = values[m_bCartesian ? index % values.size() : index];
+        if (m_bCartesian) index /= values.size();
+    }
+    return res;
+}
+
+void Sweep::point_to_json( FILE* file, unsigned int index ) const {
+    const auto point = get_point(index);
+    fprintf(file, "{");
+    for (unsigned int i = 0; i < m_aDimensions.size(); i++) {
+        fprintf(file, "\"%s\": %s%s", m_aDimensions[i].name.c_str(), Config::value_to_json(m_aDimensions[i].name, point[i]).c_str(), i==m_aDimensions.size()-1 ? "" : ", ");
+    }
+    fprintf(file, "}");
+}
+
+int Sweep::run( routine_main_t main, int argc, char **argv, char **envp ) {
+    Sweep sweep;
+    ThreadScaling scaling;
+    Config::load(argc, argv);
+    process_environment_variables(&sweep);
+
+    // the scaling mode is a sweep over the thread counts
+    ThreadScaling::process_environment_variables(&scaling);
+    const bool is_scaling = !scaling.m_aThreadCounts.empty();
+    if (is_scaling) {
+        if (!sweep.m_aDimensions.empty()) LOG_WARN("The scaling mode replaces the sweep of BM_SWEEP!\n");
+        sweep.m_bCartesian = true;
+        sweep.parse(scaling.get_sweep_grid());
+    }
+    const unsigned int num_points = sweep.get_num_points();
+    if (num_points == 0) return main(argc, argv, envp);
+
+    // every point writes its results into a temporary file, which gets copied into the result set
+    const std::string data_filepath = expand_routine_path(get_config("BM_DATA_FILEPATH"));
+    const std::string result_filepath = get_config("BM_RESULT_FILEPATH");
+    const std::string point_filepath = (data_filepath.empty() ? std::string("/tmp/benchmark.json") : data_filepath) + ".point";
+    FILE* file = data_filepath.empty() ? stdout : fopen(data_filepath.c_str(), "w");
+    if (file == nullptr) {
+        LOG_ERROR("Could not open file at \"%s\". Error %d: %s\n", data_filepath.c_str(), errno, strerror(errno));
+        return 1;
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "    \"sweepMode\": \"%s\",\n", sweep.m_bCartesian ? "cartesian" : "list");
+    fprintf(file, "    \"parameters\": [");
+        for (unsigned int i = 0; i < sweep.m_aDimensions.size(); i++) fprintf(file, "\"%s\"%s", sweep.m_aDimensions[i].name.c_str(), i==sweep.m_aDimensions.size()-1 ? "" : ", ");
+        fprintf(file, "],\n");
+    fprintf(file, "    \"points\": [");
+
+    int res = 0;
+    if (is_scaling) ThreadScaling::m_pActive = &scaling;
+    for (unsigned int i = 0; i < num_points; i++) {
+        const auto point = sweep.get_point(i);
+        std::string description;
+        for (unsigned int d = 0; d < point.size(); d++) description += (d == 0 ? "" : ", ") + sweep.m_aDimensions[d].name + "=" + point[d];
+        LOG_INFO("Running sweep point %u of %u (%s)...\n", i+1, num_points, description.c_str());
+
+        // run the routine with the values of the point
+        int status = 0;
+        {
+            TRACE_SPAN("sweep point");
+            for (unsigned int d = 0; d < point.size(); d++) Config::set_override(sweep.m_aDimensions[d].name, point[d]);
+            Config::set_override("BM_DATA_FILEPATH", point_filepath);
+            if (!result_filepath.empty()) Config::set_override("BM_RESULT_FILEPATH", result_filepath + "." + std::to_string(i));
+            unlink(point_filepath.c_str());
+            if (is_scaling) scaling.begin_step(scaling.m_aThreadCounts[i]);
+            status = main(argc, argv, envp);
+            Config::clear_overrides();
+        }
+        if (status != 0) {
+            LOG_ERROR("Sweep point %u failed with status %d!\n", i+1, status);
+            res = status;
+        }
+
+        // copy the results of the point
+        std::ifstream point_file(point_filepath.c_str());
+        std::string content((std::istreambuf_iterator<char>(point_file)), std::istreambuf_iterator<char>());
+        while (!content.empty() && (content.back() == '\n' || content.back() == ' ')) content.pop_back();
+        fprintf(file, "%s{\"parameters\": ", i == 0 ? "\n        " : ",\n        ");
+        sweep.point_to_json(file, i);
+        fprintf(file, ", \"status\": %d, \"result\": %s}", status, content.empty() ? "null" : content.c_str());
+        fflush(file);
+        unlink(point_filepath.c_str());
+    }
+    fprintf(file, "],\n");
+    ThreadScaling::m_pActive = nullptr;
+    if (is_scaling) {
+        scaling.analyze();
+        fprintf(file, "    \"scaling\": ");
+            scaling.to_json(file);
+            fprintf(file, ",\n");
+    }
+    fprintf(file, "    \"type\": \"SWEEP\"");
+    fprintf(file, "}\n");
+    if (file != stdout) fclose(file);
+    return res;
+}
+
+void Sweep::process_environment_variables( Sweep* sweep ) {
+    if (sweep == nullptr) return;
+
+    // cartesian runs every combination of the values, list runs the i-th values of all keys together
+    sweep->m_bCartesian = get_config("BM_SWEEP_MODE", std::string("cartesian")) != "list";
+
+    // the grid, e.g. "BM_BUFFER_SIZE=1024,4096;BM_NUM_THREADS=1,2,4", empty runs the routine once
+    const auto grid = get_config("BM_SWEEP");
+    if (!grid.empty() && !sweep->parse(grid)) {
+        LOG_ERROR("Ignoring the invalid sweep \"%s\"!\n", grid.c_str());
+        sweep->m_aDimensions.clear();
+    }
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "./registry.h"
+
+/**
+ * @brief A swept config key and its values
+ */
+struct SweepDimension {
+
+    // the config key, e.g. "BM_NUM_THREADS"
+    std::string name;
+
+    // the values of the key in the order they are run
+    std::vector<std::string> values;
+
+};
+
+/**
+ * @brief Runs a routine once per point of a grid over config keys in a single
+ * process, e.g. BM_SWEEP="BM_BUFFER_SIZE=1024,4096;BM_NUM_THREADS=1,2,4".
+ * Every point overrides the swept keys while the routine runs, so any parameter
+ * the routine reads from the config can be swept. The results of all points
+ * are written into BM_DATA_FILEPATH as a single result set. The scaling mode
+ * (BM_SCALING_THREADS) sweeps BM_NUM_THREADS and adds the scaling curve
+ */
+class Sweep {
+
+    public:
+
+        // the swept keys, the last one changes fastest in cartesian mode
+        std::vector<SweepDimension> m_aDimensions;
+
+        // true runs the cartesian product of all dimensions, false runs the
+        // i-th values of all dimensions as i-th point (all must have the same length)
+        bool m_bCartesian = true;
+
+        /**
+         * @brief Parses the grid, dimensions are separated by ";" and values by ","
+         *
+         * @returns false if the grid is invalid
+         */
+        bool parse( const std::string &grid );
+
+        /**
+         * @brief Returns the amount of points of the grid
+         */
+        unsigned int get_num_points() const;
+
+        /**
+         * @brief Returns the value of every dimension at the given point
+         */
+        std::vector<std::string> get_point( unsigned int index ) const;
+
+        /**
+         * @brief Writes the swept keys and their values at the given point as JSON object
+         */
+        void point_to_json( FILE* file, unsigned int index ) const;
+
+        /**
+         * @brief Runs the routine once per point of the sweep configured by
+         * BM_SWEEP or BM_SCALING_THREADS, or once without a sweep
+         *
+         * @returns 0 if the routine succeeded at every point
+         */
+        static int run( routine_main_t main, int argc, char **argv, char **envp );
+
+        /**
+         * @brief Checks the environment variables for matching parameters
+         *
+         * @param sweep [OUT]: The grid and the mode of the sweep
+         */
+        static void process_environment_variables( Sweep* sweep );
+
+};
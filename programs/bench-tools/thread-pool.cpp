@@ -0,0 +1,94 @@
+#include "./thread-pool.h"
+#include "./topology.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+unsigned int ThreadPool::size() const {
+    return m_aThreads.size();
+}
+
+void ThreadPool::worker( ThreadPool* self, unsigned int worker_num ) {
+    unsigned long epoch = 0;
+    cpu_set_t initial_affinity;
+    pthread_getaffinity_np(pthread_self(), sizeof(initial_affinity), &initial_affinity);
+
+    while (true) {
+
+        // sleep until the next epoch. The workers synchronize among each other in
+        // the task, so there is no need to spin here and burn CPU time while other
+        // workers are still running
+        {
+            std::unique_lock<std::mutex> lock(self->m_oMutex);
+            self->m_oWakeup.wait(lock, [&]() { return self->m_uEpoch.load(std::memory_order_acquire) != epoch; });
+        }
+        epoch = self->m_uEpoch.load(std::memory_order_acquire);
+        if (self->m_bStopping.load(std::memory_order_acquire)) return;
+
+        // pin only if the placement changed since the last task
+        if (worker_num < self->m_uNumActive) {
+            if (self->m_aPinnedCpus[worker_num] != self->m_aCpus[worker_num]) {
+                if (self->m_aCpus[worker_num] < 0) {
+                    pthread_setaffinity_np(pthread_self(), sizeof(initial_affinity), &initial_affinity);
+                } else {
+                    ThreadPlacement::pin_current_thread(self->m_aCpus[worker_num]);
+                }
+                self->m_aPinnedCpus[worker_num] = self->m_aCpus[worker_num];
+            }
+            self->m_oTask(worker_num);
+        }
+
+        // idle workers report as well, so no worker can miss an epoch. The last
+        // worker wakes up the dispatching thread
+        if (self->m_uNumBusy.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(self->m_oMutex);
+            self->m_oDone.notify_one();
+        }
+    }
+}
+
+void ThreadPool::run( const std::vector<int> &cpus, const std::function<void( unsigned int )> &task ) {
+    if (cpus.empty()) return;
+
+    // stop the old workers before spawning new ones, otherwise they could miss an epoch
+    if (cpus.size() > m_aThreads.size()) {
+        stop();
+        m_aPinnedCpus.assign(cpus.size(), -1);
+        m_aCpus.assign(cpus.size(), -1);
+        m_uEpoch.store(0, std::memory_order_relaxed);
+        m_bStopping.store(false, std::memory_order_relaxed);
+        for (unsigned int i = 0; i < cpus.size(); i++) m_aThreads.push_back(std::thread(worker, this, i));
+    }
+
+    // dispatch the task
+    {
+        std::lock_guard<std::mutex> lock(m_oMutex);
+        for (unsigned int i = 0; i < cpus.size(); i++) m_aCpus[i] = cpus[i];
+        m_oTask = task;
+        m_uNumActive = cpus.size();
+        m_uNumBusy.store(m_aThreads.size(), std::memory_order_relaxed);
+        m_uEpoch.fetch_add(1, std::memory_order_release);
+    }
+    m_oWakeup.notify_all();
+
+    // wait for the workers
+    std::unique_lock<std::mutex> lock(m_oMutex);
+    m_oDone.wait(lock, [&]() { return m_uNumBusy.load(std::memory_order_acquire) == 0; });
+    m_oTask = nullptr;
+}
+
+void ThreadPool::stop() {
+    if (m_aThreads.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_oMutex);
+        m_bStopping.store(true, std::memory_order_release);
+        m_uEpoch.fetch_add(1, std::memory_order_release);
+    }
+    m_oWakeup.notify_all();
+    for (auto &t : m_aThreads) t.join();
+    m_aThreads.clear();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+/**
+ * @brief A pool of pinned worker threads that stay alive for the whole process,
+ * so consecutive runs don't pay for the thread creation. A task is handed to the
+ * workers by incrementing an epoch counter, idle workers sleep until it changes
+ */
+class ThreadPool {
+
+    private:
+
+        // the worker threads
+        std::vector<std::thread> m_aThreads;
+
+        // the CPU every worker shall run on, -1 if not pinned
+        std::vector<int> m_aCpus;
+
+        // the CPU every worker is currently pinned to
+        std::vector<int> m_aPinnedCpus;
+
+        // the task of the current epoch
+        std::function<void( unsigned int )> m_oTask;
+
+        // the amount of workers that execute the current task
+        unsigned int m_uNumActive = 0;
+
+        // gets incremented for every dispatched task
+        std::atomic<unsigned long> m_uEpoch{0};
+
+        // the amount of workers that did not finish the current epoch yet
+        std::atomic<unsigned int> m_uNumBusy{0};
+
+        // set to true to terminate all workers
+        std::atomic<bool> m_bStopping{false};
+
+        // guards the condition variables
+        std::mutex m_oMutex;
+
+        // wakes up sleeping workers
+        std::condition_variable m_oWakeup;
+
+        // wakes up the dispatching thread
+        std::condition_variable m_oDone;
+
+        /**
+         * @brief The main loop of every worker
+         */
+        static void worker( ThreadPool* self, unsigned int worker_num );
+
+    public:
+
+        ThreadPool() {}
+        ThreadPool( const ThreadPool& ) = delete;
+        ThreadPool& operator=( const ThreadPool& ) = delete;
+        ~ThreadPool();
+
+        /**
+         * @brief Returns the amount of workers
+         */
+        unsigned int size() const;
+
+        /**
+         * @brief Executes the task on the first cpus.size() workers and blocks until
+         * all of them returned. Spawns new workers if there are not enough
+         *
+         * @param cpus The CPU to pin every worker to, -1 to not pin it
+         * @param task The function to execute, gets the worker number as parameter
+         */
+        void run( const std::vector<int> &cpus, const std::function<void( unsigned int )> &task );
+
+        /**
+         * @brief Stops and joins all workers
+         */
+        void stop();
+
+};
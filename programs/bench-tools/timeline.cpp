@@ -0,0 +1,188 @@
+#include "./timeline.h"
+#include "./benchmark.h"
+
+#include <math.h>
+#include <chrono>
+
+// the minimum amount of intervals between two changepoints
+#define MIN_SEGMENT_LENGTH 8
+
+// the 95% quantile of the supremum of a Brownian bridge
+#define CUSUM_CRITICAL_VALUE 1.358
+
+// shifts of the mean smaller than this fraction are ignored, so slow drifts
+// don't show up as mode switches
+#define MIN_RELATIVE_SHIFT 0.1
+
+static double get_mean( const std::vector<double> &values, unsigned int begin, unsigned int end ) {
+    double sum = 0.0;
+    for (unsigned int i = begin; i < end; i++) sum += values[i];
+    return end > begin ? sum / (end-begin) : 0.0;
+}
+
+void TimelineSeries::clear() {
+    m_aTimes.clear();
+    m_aThroughputs.clear();
+    m_aCpuUtilizations.clear();
+    m_aChangepoints.clear();
+}
+
+void TimelineSeries::find_changepoints( const std::vector<double> &values, unsigned int begin, unsigned int end, double sigma, std::vector<unsigned int>* indices ) {
+    if (end-begin < 2*MIN_SEGMENT_LENGTH) return;
+
+    // the split with the largest cumulative deviation from the mean
+    const double mean = get_mean(values, begin, end);
+    double sum = 0.0, max = 0.0;
+    unsigned int split = 0;
+    for (unsigned int i = begin; i < end-MIN_SEGMENT_LENGTH; i++) {
+        sum += values[i] - mean;
+        if (i+1-begin >= MIN_SEGMENT_LENGTH && fabs(sum) > max) {
+            max = fabs(sum);
+            split = i+1;
+        }
+    }
+    if (split == 0 || max / (sigma * sqrt(end-begin)) < CUSUM_CRITICAL_VALUE) return;
+    const double before = get_mean(values, begin, split);
+    const double after = get_mean(values, split, end);
+    if (fabs(after-before) < MIN_RELATIVE_SHIFT * std::max(fabs(before), fabs(after))) return;
+
+    indices->push_back(split);
+    find_changepoints(values, begin, split, sigma, indices);
+    find_changepoints(values, split, end, sigma, indices);
+}
+
+void TimelineSeries::detect_changepoints( const std::vector<double> &values, const char* metric ) {
+    std::vector<unsigned int> indices;
+    std::vector<double> diffs;
+    if (values.size() < 2*MIN_SEGMENT_LENGTH) return;
+
+    // estimate the noise from the differences of neighbours, so shifts of
+    // the mean don't inflate it
+    for (unsigned int i = 1; i < values.size(); i++) diffs.push_back(fabs(values[i]-values[i-1]));
+    std::sort(diffs.begin(), diffs.end());
+    double sigma = 1.4826 * diffs[diffs.size()/2] / sqrt(2.0);
+    if (sigma <= 0.0) sigma = 1e-9 * std::max(fabs(get_mean(values, 0, values.size())), 1.0);
+
+    find_changepoints(values, 0, values.size(), sigma, &indices);
+    std::sort(indices.begin(), indices.end());
+    for (unsigned int i = 0; i < indices.size(); i++) {
+        TimelineChangepoint changepoint;
+        changepoint.index = indices[i];
+        changepoint.metric = metric;
+        changepoint.mean_before = get_mean(values, i == 0 ? 0 : indices[i-1], indices[i]);
+        changepoint.mean_after = get_mean(values, indices[i], i == indices.size()-1 ? values.size() : indices[i+1]);
+        m_aChangepoints.push_back(changepoint);
+    }
+}
+
+void TimelineSeries::detect_changepoints() {
+    m_aChangepoints.clear();
+    detect_changepoints(m_aThroughputs, "throughput");
+    detect_changepoints(m_aCpuUtilizations, "cpuUtilization");
+}
+
+void TimelineSeries::to_json( FILE* file ) const {
+    fprintf(file, "{\"timesMicroseconds\": [");
+        for (unsigned int i = 0; i < m_aTimes.size(); i++) fprintf(file, "%.17g%s", m_aTimes[i], i==m_aTimes.size()-1 ? "" : ", ");
+        fprintf(file, "], ");
+    fprintf(file, "\"throughputs\": [");
+        for (unsigned int i = 0; i < m_aThroughputs.size(); i++) fprintf(file, "%.17g%s", m_aThroughputs[i], i==m_aThroughputs.size()-1 ? "" : ", ");
+        fprintf(file, "], ");
+    fprintf(file, "\"cpuUtilizations\": [");
+        for (unsigned int i = 0; i < m_aCpuUtilizations.size(); i++) fprintf(file, "%.17g%s", m_aCpuUtilizations[i], i==m_aCpuUtilizations.size()-1 ? "" : ", ");
+        fprintf(file, "], ");
+    fprintf(file, "\"changepoints\": ");
+        changepoints_to_json(file);
+        fprintf(file, "}");
+}
+
+void TimelineSeries::changepoints_to_json( FILE* file ) const {
+    fprintf(file, "[");
+    for (unsigned int i = 0; i < m_aChangepoints.size(); i++) {
+        const auto &c = m_aChangepoints[i];
+        fprintf(file, "{\"index\": %u, \"timeMicroseconds\": %.17g, \"metric\": \"%s\", \"meanBefore\": %.17g, \"meanAfter\": %.17g}%s",
+            c.index, m_aTimes[c.index], c.metric, c.mean_before, c.mean_after, i==m_aChangepoints.size()-1 ? "" : ", ");
+    }
+    fprintf(file, "]");
+}
+
+TimelineRecorder::~TimelineRecorder() {
+    if (!m_oThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_oMutex);
+        m_bStopping = true;
+    }
+    m_oWakeup.notify_all();
+    m_oThread.join();
+}
+
+void TimelineRecorder::take_sample() {
+    double usr_time, sys_time;
+    CpuTimeSnapshot cpu_time;
+    const uint64_t now = Clock::now();
+    uint64_t ops = 0;
+    for (unsigned int i = 0; i < m_uNumCounters; i++) ops += m_pCounters[i].ops.load(std::memory_order_relaxed);
+    m_oCpuTimeSampler.sample(&cpu_time);
+
+    const double duration = Clock::to_micros(now-m_uLastTime);
+    if (duration <= 0.0) return;
+    m_oCpuTimeSampler.get_diff(m_oLastCpuTime, cpu_time, &usr_time, &sys_time);
+    m_oSeries.m_aTimes.push_back(Clock::to_micros(now-m_uStart));
+    m_oSeries.m_aThroughputs.push_back((ops-m_uLastOps) * 1e6 / duration);
+    m_oSeries.m_aCpuUtilizations.push_back((usr_time+sys_time) / duration);
+    m_uLastTime = now;
+    m_uLastOps = ops;
+    m_oLastCpuTime = cpu_time;
+}
+
+void TimelineRecorder::sampler( TimelineRecorder* self ) {
+    std::unique_lock<std::mutex> lock(self->m_oMutex);
+    while (true) {
+        self->m_oWakeup.wait(lock, [&]() { return self->m_bActive || self->m_bStopping; });
+        if (self->m_bStopping) return;
+
+        // absolute deadlines, so the time of a sample does not shift the following ones
+        auto deadline = std::chrono::steady_clock::now();
+        while (self->m_bActive && !self->m_bStopping) {
+            deadline += std::chrono::microseconds(self->m_uIntervalMicroseconds);
+            if (self->m_oWakeup.wait_until(lock, deadline, [&]() { return !self->m_bActive || self->m_bStopping; })) break;
+            self->take_sample();
+        }
+    }
+}
+
+void TimelineRecorder::prepare( unsigned int num_threads, const std::vector<std::string> &stat_filepaths ) {
+    if (m_uIntervalMicroseconds == 0) return;
+    if (num_threads > m_uNumCounters) {
+        m_pCounters.reset(new TimelineCounter[num_threads]);
+        m_uNumCounters = num_threads;
+    }
+    for (unsigned int i = 0; i < m_uNumCounters; i++) m_pCounters[i].ops.store(0, std::memory_order_relaxed);
+    if (!m_bCpuTimeSamplerOpen) m_bCpuTimeSamplerOpen = m_oCpuTimeSampler.open(stat_filepaths);
+    if (!m_oThread.joinable()) m_oThread = std::thread(sampler, this);
+}
+
+void TimelineRecorder::start() {
+    if (m_uIntervalMicroseconds == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(m_oMutex);
+        m_oSeries.clear();
+        m_oCpuTimeSampler.refresh();
+        m_oCpuTimeSampler.sample(&m_oLastCpuTime);
+        m_uStart = m_uLastTime = Clock::now();
+        m_uLastOps = 0;
+        m_bActive = true;
+    }
+    m_oWakeup.notify_all();
+}
+
+void TimelineRecorder::stop( TimelineSeries* series ) {
+    if (m_uIntervalMicroseconds == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(m_oMutex);
+        take_sample();
+        m_bActive = false;
+        *series = m_oSeries;
+    }
+    m_oWakeup.notify_all();
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+
+#include "./cpu-time.h"
+
+// the amount of calls after which a thread publishes its progress
+#define TIMELINE_CHUNK_SIZE 64
+
+/**
+ * @brief The progress of a single thread. Every counter has its own cache line,
+ * so the threads don't invalidate each other's counters
+ */
+struct alignas(64) TimelineCounter {
+
+    // the amount of completed calls
+    std::atomic<uint64_t> ops{0};
+
+};
+
+/**
+ * @brief A point in a timeline where the mean of a metric shifted
+ */
+struct TimelineChangepoint {
+
+    // the first interval after the shift
+    unsigned int index;
+
+    // "throughput" or "cpuUtilization"
+    const char* metric;
+
+    // the mean of the metric in the segments before and after the shift
+    double mean_before;
+    double mean_after;
+
+};
+
+/**
+ * @brief The throughput and CPU utilization of a single run over time
+ */
+class TimelineSeries {
+
+    protected:
+
+        /**
+         * @brief Finds shifts of the mean in values[begin, end) by binary
+         * segmentation with a CUSUM statistic
+         */
+        static void find_changepoints( const std::vector<double> &values, unsigned int begin, unsigned int end, double sigma, std::vector<unsigned int>* indices );
+
+        /**
+         * @brief Finds shifts of the mean of the given metric and appends them
+         * to m_aChangepoints
+         */
+        void detect_changepoints( const std::vector<double> &values, const char* metric );
+
+    public:
+
+        // the time since the start at the end of every interval in microseconds
+        std::vector<double> m_aTimes;
+
+        // the completed calls of all threads per second in every interval
+        std::vector<double> m_aThroughputs;
+
+        // the CPU time per wall-clock time in every interval, i.e. the amount of busy CPUs
+        std::vector<double> m_aCpuUtilizations;
+
+        // the detected shifts of the throughput or the CPU utilization
+        std::vector<TimelineChangepoint> m_aChangepoints;
+
+        /**
+         * @brief Removes all samples
+         */
+        void clear();
+
+        /**
+         * @brief Detects the changepoints of the throughput and the CPU utilization
+         */
+        void detect_changepoints();
+
+        /**
+         * @brief Writes the timeline as JSON object
+         *
+         * @param file The file to write the timeline into
+         */
+        void to_json( FILE* file ) const;
+
+        /**
+         * @brief Writes the changepoints as JSON array
+         *
+         * @param file The file to write the changepoints into
+         */
+        void changepoints_to_json( FILE* file ) const;
+
+};
+
+/**
+ * @brief Records a timeline while a benchmark runs. The benchmark threads count
+ * their completed calls in a TimelineCounter and a sampler thread reads these
+ * counters and the CPU time of the process every m_uIntervalMicroseconds
+ */
+class TimelineRecorder {
+
+    protected:
+
+        // the progress of every benchmark thread
+        std::unique_ptr<TimelineCounter[]> m_pCounters;
+        unsigned int m_uNumCounters = 0;
+
+        // the sampler thread, started by the first call of prepare()
+        std::thread m_oThread;
+
+        // guards the state below
+        std::mutex m_oMutex;
+
+        // wakes up the sampler thread
+        std::condition_variable m_oWakeup;
+
+        // true while a benchmark runs
+        bool m_bActive = false;
+
+        // set to true to terminate the sampler thread
+        bool m_bStopping = false;
+
+        // the sampler has its own files, so it does not interfere with the
+        // CPU time snapshots of the benchmark
+        CpuTimeSampler m_oCpuTimeSampler;
+        bool m_bCpuTimeSamplerOpen = false;
+
+        // the state at the previous sample
+        CpuTimeSnapshot m_oLastCpuTime;
+        uint64_t m_uStart = 0;
+        uint64_t m_uLastTime = 0;
+        uint64_t m_uLastOps = 0;
+
+        // the timeline of the current run
+        TimelineSeries m_oSeries;
+
+        /**
+         * @brief Appends the interval since the previous sample to the series.
+         * The caller must hold m_oMutex
+         */
+        void take_sample();
+
+        /**
+         * @brief The main loop of the sampler thread
+         */
+        static void sampler( TimelineRecorder* self );
+
+    public:
+
+        // the time between two samples in microseconds. 0 disables the timeline
+        unsigned int m_uIntervalMicroseconds = 0;
+
+        TimelineRecorder() {}
+        TimelineRecorder( const TimelineRecorder& ) = delete;
+        TimelineRecorder& operator=( const TimelineRecorder& ) = delete;
+        ~TimelineRecorder();
+
+        /**
+         * @brief Returns the counter of the given thread or nullptr if the
+         * timeline is disabled
+         */
+        inline std::atomic<uint64_t>* get_counter( unsigned int thread_num ) {
+            if (m_uIntervalMicroseconds == 0 || thread_num >= m_uNumCounters) return nullptr;
+            return &m_pCounters[thread_num].ops;
+        }
+
+        /**
+         * @brief Resets the counters of the given amount of threads and starts
+         * the sampler thread if needed. Must be called before the benchmark
+         * threads start
+         *
+         * @param num_threads The amount of benchmark threads
+         * @param stat_filepaths The stat files of the processes to sample
+         */
+        void prepare( unsigned int num_threads, const std::vector<std::string> &stat_filepaths );
+
+        /**
+         * @brief Starts sampling
+         */
+        void start();
+
+        /**
+         * @brief Takes a last sample, stops sampling and returns the timeline.
+         * The changepoints are not detected yet, so this can be called in the
+         * timed region
+         *
+         * @param series [OUT]: The timeline of the run
+         */
+        void stop( TimelineSeries* series );
+
+};
@@ -0,0 +1,181 @@
+#include "./topology.h"
+#include "./benchmark.h"
+
+#include <sched.h>
+#include <pthread.h>
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+
+#define CPU_SYSFS_DIRECTORY "/sys/devices/system/cpu"
+#define SPINS_BEFORE_YIELD (1u << 14)
+
+struct CpuInfo {
+    int cpu;
+    int package;
+    int core;
+    int sibling_rank; // 0 for the first SMT thread of a core, 1 for the second, ...
+};
+
+static int read_topology_value( int cpu, const char* name ) {
+    int value = -1;
+    std::ifstream file(std::string(CPU_SYSFS_DIRECTORY "/cpu") + std::to_string(cpu) + "/topology/" + name);
+    if (file.good()) file >> value;
+    return value;
+}
+
+static inline void spin_wait( unsigned int &spins ) {
+    if (++spins < SPINS_BEFORE_YIELD) {
+        __asm__ __volatile__( "pause" : : : "memory" );
+    } else {
+        sched_yield(); // more threads than CPUs, let the others arrive
+    }
+}
+
+void SpinBarrier::reset( unsigned int num_threads ) {
+    m_uNumThreads = num_threads;
+    m_uArrived.store(0, std::memory_order_relaxed);
+}
+
+void SpinBarrier::wait( const std::function<void()> &completion ) {
+    const unsigned int generation = m_uGeneration.load(std::memory_order_acquire);
+    unsigned int spins = 0;
+    if (m_uArrived.fetch_add(1, std::memory_order_acq_rel)+1 == m_uNumThreads) {
+        if (completion) completion();
+        m_uArrived.store(0, std::memory_order_relaxed);
+        m_uGeneration.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    while (m_uGeneration.load(std::memory_order_acquire) == generation) spin_wait(spins);
+}
+
+void SpinBarrier::arrive( const std::function<void()> &completion ) {
+    if (m_uArrived.fetch_add(1, std::memory_order_acq_rel)+1 == m_uNumThreads) {
+        if (completion) completion();
+        m_uArrived.store(0, std::memory_order_relaxed);
+        m_uGeneration.fetch_add(1, std::memory_order_release);
+    }
+}
+
+
+
+
+std::vector<int> ThreadPlacement::get_sorted_cpus( PlacementPolicy policy ) {
+    std::vector<CpuInfo> cpus;
+    std::string online;
+    std::ifstream file(CPU_SYSFS_DIRECTORY "/online");
+    if (!file.good() || !(file >> online)) {
+        LOG_WARN("Could not read the online CPUs! Not pinning any threads\n");
+        return {};
+    }
+
+    // read topology of every online CPU
+    for (int cpu : parse_cpu_list(online)) {
+        CpuInfo info = { cpu, read_topology_value(cpu, "physical_package_id"), read_topology_value(cpu, "core_id"), 0 };
+        for (const auto &other : cpus) {
+            if (other.package == info.package && other.core == info.core) info.sibling_rank++;
+        }
+        cpus.push_back(info);
+    }
+
+    // sort by policy
+    std::stable_sort(cpus.begin(), cpus.end(), [policy]( const CpuInfo &a, const CpuInfo &b ) {
+        switch (policy) {
+            case PlacementPolicy::COMPACT:
+                if (a.sibling_rank != b.sibling_rank) return a.sibling_rank < b.sibling_rank;
+                if (a.package != b.package) return a.package < b.package;
+                return a.core < b.core;
+            case PlacementPolicy::SCATTER:
+                if (a.sibling_rank != b.sibling_rank) return a.sibling_rank < b.sibling_rank;
+                if (a.core != b.core) return a.core < b.core;
+                return a.package < b.package;
+            case PlacementPolicy::SMT:
+                if (a.package != b.package) return a.package < b.package;
+                if (a.core != b.core) return a.core < b.core;
+                return a.sibling_rank < b.sibling_rank;
+            default:
+                return a.cpu < b.cpu;
+        }
+    });
+
+    std::vector<int> res;
+    for (const auto &info : cpus) res.push_back(info.cpu);
+    return res;
+}
+
+std::vector<int> ThreadPlacement::get_cpus( unsigned int num_threads ) const {
+    std::vector<int> res(num_threads, -1);
+    const auto cpus = m_ePolicy == PlacementPolicy::LIST ? m_aCpuList : get_sorted_cpus(m_ePolicy);
+    if (m_ePolicy == PlacementPolicy::NONE || cpus.empty()) return res;
+    if (num_threads > cpus.size()) LOG_WARN("Placing %u threads on %lu CPUs, some CPUs are used twice!\n", num_threads, cpus.size());
+    for (unsigned int i = 0; i < num_threads; i++) res[i] = cpus[i % cpus.size()];
+    return res;
+}
+
+const char* ThreadPlacement::get_policy_name() const {
+    switch (m_ePolicy) {
+        case PlacementPolicy::COMPACT: return "compact";
+        case PlacementPolicy::SCATTER: return "scatter";
+        case PlacementPolicy::SMT: return "smt";
+        case PlacementPolicy::LIST: return "list";
+        default: return "none";
+    }
+}
+
+bool ThreadPlacement::pin_current_thread( int cpu ) {
+    cpu_set_t set;
+    if (cpu < 0) return true;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        LOG_WARN("Could not pin thread to CPU %d! Error %d: %s\n", cpu, err, strerror(err));
+        return false;
+    }
+    return true;
+}
+
+std::vector<int> ThreadPlacement::parse_cpu_list( const std::string &list ) {
+    std::vector<int> res;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+        const std::string range = list.substr(pos, end-pos);
+        const size_t dash = range.find('-');
+        if (!range.empty()) {
+            const int first = atoi(range.c_str());
+            const int last = dash == std::string::npos ? first : atoi(range.c_str()+dash+1);
+            for (int cpu = first; cpu <= last; cpu++) res.push_back(cpu);
+        }
+        pos = end+1;
+    }
+    return res;
+}
+
+void ThreadPlacement::process_environment_variables( ThreadPlacement* placement ) {
+    if (placement == nullptr) return;
+
+    // the placement policy
+    const auto policy = get_config("BM_THREAD_PLACEMENT", std::string("none"));
+    if (policy == "compact") {
+        placement->m_ePolicy = PlacementPolicy::COMPACT;
+    } else if (policy == "scatter") {
+        placement->m_ePolicy = PlacementPolicy::SCATTER;
+    } else if (policy == "smt") {
+        placement->m_ePolicy = PlacementPolicy::SMT;
+    } else if (policy == "list") {
+        placement->m_ePolicy = PlacementPolicy::LIST;
+    } else {
+        if (policy != "none") LOG_WARN("Unknown thread placement \"%s\"! Not pinning any threads\n", policy.c_str());
+        placement->m_ePolicy = PlacementPolicy::NONE;
+    }
+
+    // the CPUs for the list policy
+    placement->m_aCpuList = parse_cpu_list(get_config("BM_CPU_LIST"));
+    if (placement->m_ePolicy == PlacementPolicy::LIST && placement->m_aCpuList.empty()) {
+        LOG_WARN("Thread placement \"list\" requires BM_CPU_LIST! Not pinning any threads\n");
+        placement->m_ePolicy = PlacementPolicy::NONE;
+    }
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+
+enum class PlacementPolicy {
+    NONE,       // let the scheduler decide
+    COMPACT,    // one thread per physical core, filling up one socket after another
+    SCATTER,    // one thread per physical core, alternating between the sockets
+    SMT,        // fill up all SMT siblings of a core before using the next core
+    LIST        // use the given CPU list
+};
+
+/**
+ * @brief A barrier that busy waits instead of sleeping in the kernel, so
+ * all threads leave it within a few nanoseconds of each other. Can be reused
+ * after all threads have passed it
+ */
+class SpinBarrier {
+
+    private:
+
+        // the amount of threads that have to arrive
+        unsigned int m_uNumThreads;
+
+        // the amount of threads that arrived in the current generation
+        std::atomic<unsigned int> m_uArrived{0};
+
+        // gets incremented every time the barrier opens
+        std::atomic<unsigned int> m_uGeneration{0};
+
+    public:
+
+        SpinBarrier( unsigned int num_threads = 1 ) : m_uNumThreads(num_threads) {}
+
+        /**
+         * @brief Sets the amount of threads that have to arrive. Must not be
+         * called while threads are waiting
+         */
+        void reset( unsigned int num_threads );
+
+        /**
+         * @brief Blocks until all threads arrived. The last arriving thread
+         * executes the completion function before the others are released
+         *
+         * @param completion Executed once per generation. May be nullptr
+         */
+        void wait( const std::function<void()> &completion = nullptr );
+
+        /**
+         * @brief Arrives at the barrier without waiting for the others. The
+         * last arriving thread executes the completion function
+         *
+         * @param completion Executed once per generation. May be nullptr
+         */
+        void arrive( const std::function<void()> &completion = nullptr );
+
+};
+
+class ThreadPlacement {
+
+    private:
+
+        /**
+         * @brief Returns all online CPUs sorted by the given policy
+         */
+        static std::vector<int> get_sorted_cpus( PlacementPolicy policy );
+
+    public:
+
+        // how to distribute the threads on the CPUs
+        PlacementPolicy m_ePolicy = PlacementPolicy::NONE;
+
+        // the CPUs to use for the LIST policy
+        std::vector<int> m_aCpuList;
+
+        /**
+         * @brief Returns the CPU for every thread. -1 means that the thread
+         * must not be pinned. If there are more threads than CPUs, the CPUs
+         * are reused in the same order
+         *
+         * @param num_threads The amount of threads to place
+         */
+        std::vector<int> get_cpus( unsigned int num_threads ) const;
+
+        /**
+         * @brief Returns the policy as lower case string
+         */
+        const char* get_policy_name() const;
+
+        /**
+         * @brief Pins the calling thread to the given CPU
+         *
+         * @param cpu The CPU to run on. Nothing is done if negative
+         * @return False if the affinity could not be set
+         */
+        static bool pin_current_thread( int cpu );
+
+        /**
+         * @brief Parses a CPU list of the format "0,2,4-7"
+         */
+        static std::vector<int> parse_cpu_list( const std::string &list );
+
+        /**
+         * @brief Checks the environment variables for matching parameters
+         *
+         * @param placement [OUT]: The placement policy and CPU list
+         */
+        static void process_environment_variables( ThreadPlacement* placement );
+
+};
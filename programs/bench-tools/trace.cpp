@@ -0,0 +1,93 @@
+#include "./trace.h"
+#include "./benchmark.h"
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/syscall.h>
+
+std::vector<TraceBuffer*> Tracer::m_aBuffers;
+std::mutex Tracer::m_oMutex;
+bool Tracer::m_bEnabled = false;
+unsigned int Tracer::m_uBufferSize = 65536;
+std::string Tracer::m_sFilepath;
+
+static thread_local TraceBuffer* t_pBuffer = nullptr;
+
+TraceBuffer* Tracer::get_buffer() {
+    if (t_pBuffer != nullptr) return t_pBuffer;
+    TraceBuffer* buffer = new TraceBuffer();
+    buffer->tid = syscall(SYS_gettid);
+    buffer->name = "thread " + std::to_string(buffer->tid);
+    buffer->events.resize(m_uBufferSize == 0 ? 1 : m_uBufferSize);
+    {
+        std::lock_guard<std::mutex> lock(m_oMutex);
+        m_aBuffers.push_back(buffer);
+    }
+    t_pBuffer = buffer;
+    return buffer;
+}
+
+void Tracer::set_thread_name( const std::string &name ) {
+    if (!m_bEnabled) return;
+    TraceBuffer* buffer = get_buffer();
+    std::lock_guard<std::mutex> lock(m_oMutex);
+    buffer->name = name;
+}
+
+void Tracer::dump() {
+    if (!m_bEnabled) return;
+    std::lock_guard<std::mutex> lock(m_oMutex);
+    FILE* file = fopen(m_sFilepath.c_str(), "w");
+    if (file == nullptr) {
+        LOG_ERROR("Could not open trace file at \"%s\". Error %d: %s\n", m_sFilepath.c_str(), errno, strerror(errno));
+        return;
+    }
+
+    // the earliest event is the origin of the trace
+    uint64_t origin = UINT64_MAX, dropped = 0;
+    for (auto buffer : m_aBuffers) {
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        const uint64_t size = buffer->events.size();
+        for (uint64_t i = head > size ? head-size : 0; i < head; i++) origin = std::min(origin, buffer->events[i % size].begin);
+        if (head > size) dropped += head-size;
+    }
+    if (dropped != 0) LOG_WARN("%lu trace events were overwritten, increase BM_TRACE_BUFFER_SIZE to keep them\n", (unsigned long)dropped);
+
+    const pid_t pid = getpid();
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    for (auto buffer : m_aBuffers) {
+        fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, \"args\": {\"name\": \"%s\"}}", first ? "" : ",\n", pid, buffer->tid, buffer->name.c_str());
+        first = false;
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        const uint64_t size = buffer->events.size();
+        for (uint64_t i = head > size ? head-size : 0; i < head; i++) {
+            const TraceEvent &event = buffer->events[i % size];
+            fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": %d, ", event.name, pid, buffer->tid);
+            fprintf(file, "\"ts\": %.3f, \"dur\": %.3f}", Clock::to_micros(event.begin-origin), Clock::to_micros(event.end-event.begin));
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    LOG_INFO("Wrote trace to \"%s\"\n", m_sFilepath.c_str());
+}
+
+void Tracer::process_environment_variables() {
+
+    // the file to write the trace into, tracing is disabled without it
+    m_sFilepath = get_config("BM_TRACE_FILEPATH");
+    m_bEnabled = !m_sFilepath.empty();
+
+    // the amount of events per thread
+    if (m_bEnabled) m_uBufferSize = get_config("BM_TRACE_BUFFER_SIZE", (long)65536);
+
+    // write the trace at exit, so the setup and teardown of the routine are part of it
+    static bool registered = false;
+    if (m_bEnabled && !registered) {
+        set_thread_name("main");
+        registered = atexit(dump) == 0;
+    }
+
+}
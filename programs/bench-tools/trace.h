@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+#include "./clock.h"
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Records the scope it is placed in as span with the given name
+ */
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(name)
+
+/**
+ * @brief A span recorded by a thread
+ */
+struct TraceEvent {
+
+    // the name of the span, must be a string literal
+    const char* name;
+
+    // the clock ticks at the begin and the end of the span
+    uint64_t begin;
+    uint64_t end;
+
+};
+
+/**
+ * @brief The events of a single thread. Only the owning thread writes, so a
+ * record is a store and an index bump. Once full, the oldest events get overwritten
+ */
+struct alignas(64) TraceBuffer {
+
+    // the kernel thread id of the owner
+    pid_t tid;
+
+    // the name of the thread in the trace
+    std::string name;
+
+    // the ring of events
+    std::vector<TraceEvent> events;
+
+    // the amount of events recorded so far
+    std::atomic<uint64_t> head{0};
+
+};
+
+/**
+ * @brief Records spans into per thread ring buffers and writes them in the
+ * Chrome trace event format, which can be opened in chrome://tracing or Perfetto
+ */
+class Tracer {
+
+    private:
+
+        // the buffers of all threads that recorded an event, never freed, so
+        // the events of exited threads remain
+        static std::vector<TraceBuffer*> m_aBuffers;
+
+        // guards m_aBuffers
+        static std::mutex m_oMutex;
+
+        /**
+         * @brief Returns the buffer of the calling thread and creates it if needed
+         */
+        static TraceBuffer* get_buffer();
+
+    public:
+
+        // if false, nothing is recorded
+        static bool m_bEnabled;
+
+        // the amount of events per thread
+        static unsigned int m_uBufferSize;
+
+        // the file to write the trace into
+        static std::string m_sFilepath;
+
+        /**
+         * @brief Appends a span to the buffer of the calling thread
+         */
+        static inline void record( const char* name, uint64_t begin, uint64_t end ) {
+            TraceBuffer* buffer = get_buffer();
+            const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+            TraceEvent &event = buffer->events[head % buffer->events.size()];
+            event.name = name;
+            event.begin = begin;
+            event.end = end;
+            buffer->head.store(head + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Sets the name of the calling thread in the trace
+         */
+        static void set_thread_name( const std::string &name );
+
+        /**
+         * @brief Writes all recorded events as Chrome trace JSON to m_sFilepath.
+         * Must not be called while other threads record events. Runs at exit
+         * once tracing is enabled
+         */
+        static void dump();
+
+        /**
+         * @brief Checks the environment variables. BM_TRACE_FILEPATH enables the
+         * tracing and BM_TRACE_BUFFER_SIZE sets the amount of events per thread
+         */
+        static void process_environment_variables();
+
+};
+
+/**
+ * @brief Records its lifetime as span. Costs a branch if tracing is disabled
+ */
+class TraceSpan {
+
+    private:
+
+        const char* m_pName;
+        uint64_t m_uBegin;
+
+    public:
+
+        inline TraceSpan( const char* name ) : m_pName(name), m_uBegin(Tracer::m_bEnabled ? Clock::now() : 0) {}
+
+        inline ~TraceSpan() {
+            if (m_uBegin != 0) Tracer::record(m_pName, m_uBegin, Clock::now());
+        }
+
+        TraceSpan( const TraceSpan& ) = delete;
+        TraceSpan& operator=( const TraceSpan& ) = delete;
+
+};
@@ -0,0 +1,102 @@
+#include "./warmup.h"
+#include "./benchmark.h"
+
+#include <math.h>
+
+/**
+ * @brief Returns the least squares slope of values[begin, end) per index
+ */
+static double get_slope( const std::vector<double> &values, unsigned int begin, unsigned int end ) {
+    const double n = end-begin;
+    double sum_x = 0.0, sum_y = 0.0, sum_xy = 0.0, sum_xx = 0.0;
+    for (unsigned int i = begin; i < end; i++) {
+        const double x = i-begin;
+        sum_x += x;
+        sum_y += values[i];
+        sum_xy += x*values[i];
+        sum_xx += x*x;
+    }
+    const double denominator = n*sum_xx - sum_x*sum_x;
+    return denominator == 0.0 ? 0.0 : (n*sum_xy - sum_x*sum_y) / denominator;
+}
+
+bool SteadyStateWarmup::was_executed() {
+    return m_bWasExecuted;
+}
+
+bool SteadyStateWarmup::is_steady() const {
+    const unsigned int n = m_aRuntimes.size();
+    if (m_uWindowSize < 2 || n < 2*m_uWindowSize) return false;
+
+    // compare the medians of the last two windows
+    const std::vector<double> previous(m_aRuntimes.end()-2*m_uWindowSize, m_aRuntimes.end()-m_uWindowSize);
+    const std::vector<double> last(m_aRuntimes.end()-m_uWindowSize, m_aRuntimes.end());
+    const double previous_median = get_median(previous);
+    const double last_median = get_median(last);
+    if (last_median <= 0.0 || fabs(last_median-previous_median) > m_dTolerance*last_median) return false;
+
+    // the trend across the last window must be flat as well
+    const double drift = get_slope(m_aRuntimes, n-m_uWindowSize, n) * (m_uWindowSize-1);
+    return fabs(drift) <= m_dTolerance*last_median;
+}
+
+void SteadyStateWarmup::run( Benchmark &benchmark ) {
+    const unsigned int num_executions = benchmark.m_uNumExecutions;
+    const uint64_t start = Clock::now();
+    m_aRuntimes.clear();
+    m_aCpuTimes.clear();
+    m_dCpuTime = 0.0;
+    m_bSteady = false;
+    m_bWasExecuted = false;
+
+    // without a window, a single full batch is the warmup
+    m_uProbeExecutions = m_uWindowSize == 0 ? num_executions : std::max((unsigned int)(num_executions*m_dProbeFraction), 1u);
+    benchmark.m_uNumExecutions = m_uProbeExecutions;
+    do {
+        benchmark.run();
+        m_aRuntimes.push_back(benchmark.m_dThreadDurationMean);
+        m_aCpuTimes.push_back(benchmark.m_dFullCpuTime / m_uProbeExecutions);
+        m_dCpuTime += benchmark.m_dFullCpuTime;
+        m_bSteady = is_steady();
+    } while (m_uWindowSize != 0 && !m_bSteady && m_aRuntimes.size() < m_uMaxProbes && Clock::to_micros(Clock::now()-start) < m_dMaxDuration*1e6);
+    benchmark.m_uNumExecutions = num_executions;
+    m_dDuration = Clock::to_micros(Clock::now()-start);
+
+    if (m_uWindowSize != 0) {
+        if (m_bSteady) LOG_INFO("Reached a steady state after %lu probes (%.0fus)\n", (unsigned long)m_aRuntimes.size(), m_dDuration);
+        else LOG_WARN("No steady state after %lu probes (%.0fus), starting the measurement anyway\n", (unsigned long)m_aRuntimes.size(), m_dDuration);
+    }
+
+    // done
+    m_bWasExecuted = true;
+}
+
+void SteadyStateWarmup::to_json( FILE* file ) const {
+    fprintf(file, "{\"windowSize\": %u, ", m_uWindowSize);
+    fprintf(file, "\"tolerance\": %.17g, ", m_dTolerance);
+    fprintf(file, "\"probeExecutions\": %u, ", m_uProbeExecutions);
+    fprintf(file, "\"steady\": %s, ", m_bSteady ? "true" : "false");
+    fprintf(file, "\"durationMicroseconds\": %.17g, ", m_dDuration);
+    fprintf(file, "\"cpuTimeMicroseconds\": %.17g, ", m_dCpuTime);
+    fprintf(file, "\"runtimesMicroseconds\": [");
+        for (unsigned int i = 0; i < m_aRuntimes.size(); i++) fprintf(file, "%.17g%s", m_aRuntimes[i], i==m_aRuntimes.size()-1 ? "" : ", ");
+        fprintf(file, "], ");
+    fprintf(file, "\"cpuTimesMicroseconds\": [");
+        for (unsigned int i = 0; i < m_aCpuTimes.size(); i++) fprintf(file, "%.17g%s", m_aCpuTimes[i], i==m_aCpuTimes.size()-1 ? "" : ", ");
+        fprintf(file, "]}");
+}
+
+void SteadyStateWarmup::process_environment_variables( SteadyStateWarmup* warmup ) {
+    if (warmup == nullptr) return;
+
+    // the probes per window of the steady state test, 0 runs a single batch as warmup
+    warmup->m_uWindowSize = get_config("BM_WARMUP_WINDOW", (long)5);
+
+    // the maximum relative change of the runtime between and within windows
+    warmup->m_dTolerance = get_config("BM_WARMUP_TOLERANCE", (double)0.02);
+
+    // the budget of the warmup in probes and seconds
+    warmup->m_uMaxProbes = get_config("BM_MAX_WARMUP_PROBES", (long)100);
+    warmup->m_dMaxDuration = get_config("BM_MAX_WARMUP_DURATION", (double)30.0);
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+
+class Benchmark;
+
+/**
+ * @brief Runs short probe batches until the runtime reaches a steady state.
+ * The state is steady once the medians of the last two windows of probes
+ * differ by less than m_dTolerance and the least squares slope across the
+ * last window changes the runtime by less than m_dTolerance
+ */
+class SteadyStateWarmup {
+
+    protected:
+
+        // gets set to true once run() was executed
+        bool m_bWasExecuted = false;
+
+        /**
+         * @brief Returns true if the last two windows of m_aRuntimes pass the
+         * steady state test
+         */
+        bool is_steady() const;
+
+    public:
+
+        // the amount of probes per window. 0 runs a single full batch as warmup
+        unsigned int m_uWindowSize = 5;
+
+        // the maximum relative change of the median and over the slope of a window
+        double m_dTolerance = 0.02;
+
+        // the fraction of the executions of a batch that a probe runs
+        double m_dProbeFraction = 0.2;
+
+        // the budget of the warmup, it stops without a steady state once one is exhausted
+        unsigned int m_uMaxProbes = 100;
+        double m_dMaxDuration = 30.0;
+
+        // the executions per thread of every probe
+        unsigned int m_uProbeExecutions = 0;
+
+        // the mean runtime of a call and the CPU time per call of every probe in microseconds
+        std::vector<double> m_aRuntimes;
+        std::vector<double> m_aCpuTimes;
+
+        // the wall-clock time and the CPU time of the whole warmup in microseconds
+        double m_dDuration = 0.0;
+        double m_dCpuTime = 0.0;
+
+        // true if the steady state test passed
+        bool m_bSteady = false;
+
+        /**
+         * @brief Returns true if the warmup was already executed
+         */
+        bool was_executed();
+
+        /**
+         * @brief Runs probes of the given benchmark until the steady state or
+         * the budget is reached. The executions of the benchmark are restored
+         * afterwards
+         *
+         * @param benchmark [IN, OUT]: The benchmark to warm up
+         */
+        void run( Benchmark &benchmark );
+
+        /**
+         * @brief Writes the warmup trace as JSON object
+         *
+         * @param file The file to write the warmup into
+         */
+        void to_json( FILE* file ) const;
+
+        /**
+         * @brief Checks the environment variables for matching parameters
+         *
+         * @param warmup [OUT]: The window size, tolerance and budget of the warmup
+         */
+        static void process_environment_variables( SteadyStateWarmup* warmup );
+
+};
@@ -0,0 +1,34 @@
+#include "../bench-tools/benchmark.h"
+#include "../bench-tools/registry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+int main( int argc, char **argv, char **envp ) {
+
+    std::string patterns; // the comma separated glob patterns of the routines to run
+
+    // parse arguments, without --run the routines come from the config
+    Config::load(argc, argv);
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "--config") == 0 || strcmp(argv[i], "--config-file") == 0) && i+1 < argc) {
+            i++;
+        } else if (strcmp(argv[i], "--list") == 0) {
+            for (const auto &routine : RoutineRegistry::get_routines()) printf("%s\n", routine.name);
+            return 0;
+        } else if (strcmp(argv[i], "--run") == 0 && i+1 < argc) {
+            patterns = argv[++i];
+        } else {
+            printf("Usage: %s [--list] [--run <routine patterns, e.g. 'write*,read'>] [--config-file <path>] [--config KEY=VALUE ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (patterns.empty()) patterns = get_config("BM_ROUTINES", "*");
+    if (RoutineRegistry::find(patterns).size() > 1 && get_config("BM_DATA_FILEPATH").find(ROUTINE_PLACEHOLDER) == std::string::npos) {
+        LOG_WARN("BM_DATA_FILEPATH has no \"" ROUTINE_PLACEHOLDER "\" placeholder, every routine overwrites the results of the previous one!\n");
+    }
+
+    // run all matching routines in this process
+    return RoutineRegistry::run(patterns, argc, argv, envp);
+
+}
@@ -13,12 +13,12 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
-volatile bool running = true;
-volatile bool ready = false;
-int sockfd = 0;
-struct pollfd sockpollfd;
+static volatile bool running = true;
+static volatile bool ready = false;
+static int sockfd = 0;
+static struct pollfd sockpollfd;
 
-void run_blocking_single_thread() {
+static void run_blocking_single_thread() {
     while (running) {
         if (poll(&sockpollfd, 1, 5) == -1) {
             LOG_ERROR("Could not poll!\n");
@@ -27,7 +27,7 @@ void run_blocking_single_thread() {
     }
 }
 
-void run_blocking(unsigned int num_threads) {
+static void run_blocking(unsigned int num_threads) {
 
     struct sockaddr_in servaddr;
 
@@ -65,7 +65,7 @@ void run_blocking(unsigned int num_threads) {
 
 }
 
-int main( int argc, char **argv, char **envp ) {
+BENCH_ROUTINE("block-test") {
 
     Batch batch; // a whole batch of benchmarks
     WriteBenchmark benchmark; // a single benchmark
@@ -75,12 +75,13 @@ int main( int argc, char **argv, char **envp ) {
     benchmark.m_uBufferSize = 1;
     
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
-    Batch::process_environment_variables(&batch.m_uNumBatches);
-    Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath);
+    Batch::process_environment_variables(&batch.m_uNumBatches, &batch.m_oCalibration.m_uNumRuns, &batch.m_dTargetPrecision, &batch.m_uMinBatches, &batch.m_dMaxDuration, &batch.m_dMinBatchDuration, &batch.m_oWarmup);
+    Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath, &benchmark.m_uLatencySampleInterval, &benchmark.m_oThreadPlacement);
     WriteBenchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads);
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
-    LOG_INFO("Running benchmark %u times in %u batches and %u thread%s with buffer size %lu...\n", benchmark.m_uNumExecutions, batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s", benchmark.m_uBufferSize);
+    LOG_INFO("Running benchmark %s in %u batches and %u thread%s with buffer size %lu...\n", benchmark.get_executions_description().c_str(), batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s", benchmark.m_uBufferSize);
 
     // do benchmark
     auto blocking_bench_thread = std::thread(run_blocking, benchmark.m_uNumThreads);
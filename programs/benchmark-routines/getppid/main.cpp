@@ -1,23 +1,43 @@
-#include "../../bench-tools/benchmark.h"
+#include "../../bench-tools/kernel-benchmark.h"
 
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
 
-int main( int argc, char **argv, char **envp ) {
+struct GetppidKernel {
+
+    static inline void run( Benchmark* self, unsigned int thread_num ) {
+        getppid();
+    }
+
+    // unrolled, so the loop overhead is spread over four calls
+    static inline void run_n( Benchmark* self, unsigned int thread_num, unsigned int count ) {
+        unsigned int i = 0;
+        for (; i+4 <= count; i += 4) {
+            getppid();
+            getppid();
+            getppid();
+            getppid();
+        }
+        for (; i < count; i++) getppid();
+    }
+
+};
+
+BENCH_ROUTINE("getppid") {
 
     Batch batch; // a whole batch of benchmarks
-    Benchmark benchmark; // a single benchmark
+    KernelBenchmark<GetppidKernel> benchmark; // a single benchmark
     std::string data_filepath; // the file to write the results into
     std::string stat_filepath; // the file(s) containing the CPU times
-    benchmark.m_pFunction = (void_func_t)getppid;
 
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
-    Batch::process_environment_variables(&batch.m_uNumBatches);
-    Benchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads, &stat_filepath);
+    Batch::process_environment_variables(&batch.m_uNumBatches, &batch.m_oCalibration.m_uNumRuns, &batch.m_dTargetPrecision, &batch.m_uMinBatches, &batch.m_dMaxDuration, &batch.m_dMinBatchDuration, &batch.m_oWarmup);
+    Benchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads, &stat_filepath, &benchmark.m_uLatencySampleInterval, &benchmark.m_oThreadPlacement);
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
-    LOG_INFO("Running benchmark %u times in %u batches and %u thread%s...\n", benchmark.m_uNumExecutions, batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s");
+    LOG_INFO("Running benchmark %s in %u batches and %u thread%s...\n", benchmark.get_executions_description().c_str(), batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s");
 
     // do benchmark
     if (!Benchmark::get_stat_files(stat_filepath.c_str())) return 1;
@@ -6,7 +6,7 @@
 #include <string.h>
 #include <fcntl.h>
 
-int main( int argc, char **argv, char **envp ) {
+BENCH_ROUTINE("low-workload") {
 
     FrequencyBatch batch; // a whole batch of benchmarks
     SleepBenchmark benchmark; // a single benchmark
@@ -16,11 +16,12 @@ int main( int argc, char **argv, char **envp ) {
     benchmark.m_uBufferSize = 1;
 
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
     Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath);
     FrequencyBatch::process_environment_variables(&batch.m_uNumSamples, &batch.m_dMinFrequency, nullptr);
     batch.m_dMaxFrequency = batch.m_dMinFrequency;
-    SleepBenchmark::process_environment_variables(nullptr, &benchmark.m_uNumThreads);
+    SleepBenchmark::process_environment_variables(nullptr, &benchmark.m_uNumThreads, nullptr, &benchmark.m_bOpenLoop, &benchmark.m_oArrivals, &benchmark.m_oPacer);
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
     LOG_INFO("Running benchmark on target frequency %.0fHz...\n", batch.m_dMinFrequency );
     
@@ -4,7 +4,7 @@
 #include <stdio.h>
 #include <unistd.h>
 
-int main( int argc, char **argv, char **envp ) {
+BENCH_ROUTINE("peak-test") {
 
     PeakBatch batch; // a whole batch of benchmarks
     WriteBenchmark benchmark; // a single benchmark
@@ -14,13 +14,13 @@ int main( int argc, char **argv, char **envp ) {
     benchmark.m_uBufferSize = 1;
     
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
-    PeakBatch::process_environment_variables(&batch.m_uNumBatches);
-    Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath);
+    PeakBatch::process_environment_variables(&batch.m_uNumBatches, &batch.m_oCalibration.m_uNumRuns, &batch.m_dTargetPrecision, &batch.m_uMinBatches, &batch.m_dMaxDuration, &batch.m_dMinBatchDuration, &batch.m_oWarmup);
+    Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath, &benchmark.m_uLatencySampleInterval, &benchmark.m_oThreadPlacement);
     WriteBenchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads);
-    batch.m_uSleepTimeMicroseconds = benchmark.m_uNumExecutions*5;
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
-    LOG_INFO("Running benchmark %u times in %u batches and %u thread%s with %uus sleeps between...\n", benchmark.m_uNumExecutions, batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s", batch.m_uSleepTimeMicroseconds);
+    LOG_INFO("Running benchmark %s in %u batches and %u thread%s with %uus sleeps per execution between...\n", benchmark.get_executions_description().c_str(), batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s", batch.m_uSleepTimePerExecution);
 
     // do benchmark
     if (!Benchmark::get_stat_files(stat_filepath.c_str())) return 1;;
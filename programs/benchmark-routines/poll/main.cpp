@@ -13,10 +13,10 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
-int sockfd = 0;
-struct pollfd sockpollfd;
+static int sockfd = 0;
+static struct pollfd sockpollfd;
 
-void execute_poll() {
+static void execute_poll() {
     size_t c = 0;
     if (poll(&sockpollfd, 1, 1) == -1) {
         LOG_ERROR("Could not poll!\n");
@@ -28,7 +28,7 @@ void execute_poll() {
     }
 }
 
-int main( int argc, char **argv, char **envp ) {
+BENCH_ROUTINE("poll") {
 
     Batch batch; // a whole batch of benchmarks
     Benchmark benchmark; // a single benchmark
@@ -37,11 +37,12 @@ int main( int argc, char **argv, char **envp ) {
     benchmark.m_pFunction = (void_func_t)execute_poll;
     
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
-    Batch::process_environment_variables(&batch.m_uNumBatches);
-    Benchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads, &stat_filepath);
+    Batch::process_environment_variables(&batch.m_uNumBatches, &batch.m_oCalibration.m_uNumRuns, &batch.m_dTargetPrecision, &batch.m_uMinBatches, &batch.m_dMaxDuration, &batch.m_dMinBatchDuration, &batch.m_oWarmup);
+    Benchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads, &stat_filepath, &benchmark.m_uLatencySampleInterval, &benchmark.m_oThreadPlacement);
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
-    LOG_INFO("Running benchmark %u times in %u batches and %u thread%s...\n", benchmark.m_uNumExecutions, batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s");
+    LOG_INFO("Running benchmark %s in %u batches and %u thread%s...\n", benchmark.get_executions_description().c_str(), batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s");
 
     // prepare socket
     struct sockaddr_in servaddr;
@@ -1,61 +1,130 @@
-#include "../../bench-tools/benchmark.h"
+#include "../../bench-tools/kernel-benchmark.h"
+#include "../../bench-tools/io-uring.h"
 
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
 
-int fd;
-char buf[] = "This is a benchmark file, please ignore me!\n";
+static int fd;
+static char buf[] = "This is a benchmark file, please ignore me!\n";
 
-void bench_func() {
-    if (pread(fd, &buf, 1, 0) == -1) {
-        LOG_ERROR("Could not read file! Error %d: %s\n", errno, strerror(errno));
-        return;
+// the buffers of a preadv call, each of them reads a single byte of vector_buf
+static IoBatching batching;
+static struct iovec vectors[IOV_MAX];
+static char vector_buf[IOV_MAX];
+
+struct ReadKernel {
+
+    static inline void run( Benchmark* self, unsigned int thread_num ) {
+        if (pread(fd, &buf, 1, 0) == -1) {
+            LOG_ERROR("Could not read file! Error %d: %s\n", errno, strerror(errno));
+            return;
+        }
+        if (buf[0] != 'T') {
+            LOG_WARN("Buffer did not match the content of the file!\n");
+        }
     }
-    if (buf[0] != 'T') {
-        LOG_WARN("Buffer did not match the content of the file!\n");
+
+};
+
+struct VectoredReadKernel {
+
+    static inline void run( Benchmark* self, unsigned int thread_num ) {
+        if (preadv(fd, vectors, batching.m_uVectors, 0) == -1) {
+            LOG_ERROR("Could not read file! Error %d: %s\n", errno, strerror(errno));
+            return;
+        }
+        if (vector_buf[0] != 'T') {
+            LOG_WARN("Buffer did not match the content of the file!\n");
+        }
     }
-}
 
-int main( int argc, char **argv, char **envp ) {
+};
+
+BENCH_ROUTINE("read") {
 
     Batch batch; // a whole batch of benchmarks
-    Benchmark benchmark; // a single benchmark
+    Benchmark* benchmark; // a single benchmark
+    IoUringBenchmark* io_uring = nullptr; // the benchmark if it uses io_uring instead of pread
     std::string data_filepath; // the file to write the results into
     std::string stat_filepath; // the file(s) containing the CPU times
-    benchmark.m_pFunction = (void_func_t)bench_func;
+    bool use_io_uring; // whether to read with io_uring
 
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
-    Batch::process_environment_variables(&batch.m_uNumBatches);
-    Benchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads, &stat_filepath);
+    Batch::process_environment_variables(&batch.m_uNumBatches, &batch.m_oCalibration.m_uNumRuns, &batch.m_dTargetPrecision, &batch.m_uMinBatches, &batch.m_dMaxDuration, &batch.m_dMinBatchDuration, &batch.m_oWarmup);
+    IoBatching::process_environment_variables(&batching);
+    IoUringBenchmark::process_environment_variables(&use_io_uring);
+    if (batching.m_uCoalesce > 1) {
+        LOG_WARN("Only writes can be coalesced, ignoring BM_IO_COALESCE!\n");
+        batching.m_uCoalesce = 1;
+    }
+    if (use_io_uring && batching.m_uVectors > 1) {
+        LOG_WARN("The io_uring backend reads a single buffer per operation, ignoring BM_IO_VECTORS!\n");
+        batching.m_uVectors = 1;
+    }
+    if (use_io_uring) {
+        benchmark = io_uring = new IoUringBenchmark();
+        io_uring->m_eOperation = IoOperation::READ;
+        IoUringBenchmark::process_environment_variables(nullptr, &io_uring->m_uQueueDepth, &io_uring->m_uBatchSize, &io_uring->m_bSqPoll, &io_uring->m_bRegisterBuffers, &io_uring->m_bRegisterFiles);
+    } else if (batching.m_uVectors > 1) {
+        benchmark = new KernelBenchmark<VectoredReadKernel>();
+        for (unsigned int i = 0; i < batching.m_uVectors; i++) vectors[i] = { &vector_buf[i], 1 };
+    } else {
+        benchmark = new KernelBenchmark<ReadKernel>();
+    }
+    Benchmark::process_environment_variables(&benchmark->m_uNumExecutions, &benchmark->m_uNumThreads, &stat_filepath, &benchmark->m_uLatencySampleInterval, &benchmark->m_oThreadPlacement);
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
-    LOG_INFO("Running benchmark %u times in %u batches and %u thread%s...\n", benchmark.m_uNumExecutions, batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s");
+    LOG_INFO("Running benchmark %s in %u batches and %u thread%s...\n", benchmark->get_executions_description().c_str(), batch.m_uNumBatches, benchmark->m_uNumThreads, benchmark->m_uNumThreads == 1 ? "" : "s");
+    if (io_uring != nullptr) LOG_INFO("Using io_uring with queue depth %u...\n", io_uring->m_uQueueDepth);
+    if (batching.m_uVectors > 1) LOG_INFO("Reading %u buffers per call...\n", batching.m_uVectors);
 
     // open temp file
     fd = open("/tmp/read-benchmark.txt", O_RDWR|O_CREAT, S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH);
     unlink("/tmp/read-benchmark.txt");
-    if (write(fd, buf, sizeof(buf)) != sizeof(buf)) {
-        LOG_ERROR("Could not write to file! Error %d: %s\n", errno, strerror(errno));
+    for (size_t written = 0; written < batching.m_uVectors; written += sizeof(buf)) { // a preadv needs a byte per buffer
+        if (write(fd, buf, sizeof(buf)) != sizeof(buf)) {
+            LOG_ERROR("Could not write to file! Error %d: %s\n", errno, strerror(errno));
+            close(fd);
+            delete benchmark;
+            return 1;
+        }
+    }
+    fsync(fd);
+
+    // all threads read the same file
+    if (io_uring != nullptr && !io_uring->open_rings(std::vector<int>(io_uring->m_uNumThreads, fd), std::vector<char*>(io_uring->m_uNumThreads, buf), 1)) {
         close(fd);
+        delete benchmark;
         return 1;
     }
-    fsync(fd);
 
     // do benchmark
-    if (!Benchmark::get_stat_files(stat_filepath.c_str())) return 1;
-    batch.run(benchmark);
+    if (!Benchmark::get_stat_files(stat_filepath.c_str())) {
+        if (io_uring != nullptr) io_uring->close_rings();
+        close(fd);
+        delete benchmark;
+        return 1;
+    }
+    batch.run(*benchmark);
+    if (io_uring != nullptr) io_uring->close_rings();
     close(fd);
     
 
     // store result
     if (data_filepath.empty()) {
         batch.to_json(stdout);
+    } else if (io_uring != nullptr) {
+        batch.to_json(data_filepath.c_str(), (environment_variables_to_json_array(envp) + ",\n    " + batching.to_json(batch, 1) + ",\n    " + io_uring->settings_to_json()).c_str());
     } else {
-        batch.to_json(data_filepath.c_str(), environment_variables_to_json_array(envp).c_str());
+        batch.to_json(data_filepath.c_str(), (environment_variables_to_json_array(envp) + ",\n    " + batching.to_json(batch, 1)).c_str());
     }
+    delete benchmark;
 
     // done
     return 0;
@@ -6,7 +6,7 @@
 #include <string.h>
 #include <fcntl.h>
 
-int main( int argc, char **argv, char **envp ) {
+BENCH_ROUTINE("variable-spinning") {
 
     FrequencyBatch batch; // a whole batch of benchmarks
     FrequencyBenchmark benchmark; // a single benchmark
@@ -14,13 +14,14 @@ int main( int argc, char **argv, char **envp ) {
     std::string stat_filepath; // the file(s) containing the CPU times
     benchmark.m_pFunction = (void_func_t)WriteBenchmark::write_single_thread;
     benchmark.m_uBufferSize = 1;
-    benchmark.b_useSpinning = true;
+    benchmark.m_oPacer.m_eMode = PacingMode::SPIN;
 
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
     Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath);
-    FrequencyBatch::process_environment_variables(&batch.m_uNumSamples, &batch.m_dMinFrequency, &batch.m_dMaxFrequency);
-    FrequencyBenchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads);
+    FrequencyBatch::process_environment_variables(&batch.m_uNumSamples, &batch.m_dMinFrequency, &batch.m_dMaxFrequency, &batch.m_eSpacing, &batch.m_dSaturationThreshold, &batch.m_dSaturationTolerance);
+    FrequencyBenchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads, nullptr, &benchmark.m_bOpenLoop, &benchmark.m_oArrivals, &benchmark.m_oPacer);
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
     LOG_INFO("Running benchmark from target frequency %.0fHz to %.0fHz...\n", batch.m_dMinFrequency, batch.m_dMaxFrequency );
     
@@ -1,25 +1,25 @@
-#include "../../bench-tools/benchmark.h"
+#include "../../bench-tools/kernel-benchmark.h"
 
 #include <errno.h>
 #include <stdio.h>
 #include <unistd.h>
 
-int main( int argc, char **argv, char **envp ) {
+BENCH_ROUTINE("write-empty") {
 
     Batch batch; // a whole batch of benchmarks
-    WriteBenchmark benchmark; // a single benchmark
+    KernelBenchmark<WriteKernel<1>, WriteBenchmark> benchmark; // a single benchmark
     std::string data_filepath; // the file to write the results into
     std::string stat_filepath; // the file(s) containing the CPU times
-    benchmark.m_pFunction = (void_func_t)WriteBenchmark::write_single_thread;
     benchmark.m_uBufferSize = 1;
     
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
-    Batch::process_environment_variables(&batch.m_uNumBatches);
-    Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath);
+    Batch::process_environment_variables(&batch.m_uNumBatches, &batch.m_oCalibration.m_uNumRuns, &batch.m_dTargetPrecision, &batch.m_uMinBatches, &batch.m_dMaxDuration, &batch.m_dMinBatchDuration, &batch.m_oWarmup);
+    Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath, &benchmark.m_uLatencySampleInterval, &benchmark.m_oThreadPlacement);
     WriteBenchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads);
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
-    LOG_INFO("Running benchmark %u times in %u batches and %u thread%s with buffer size %lu...\n", benchmark.m_uNumExecutions, batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s", benchmark.m_uBufferSize);
+    LOG_INFO("Running benchmark %s in %u batches and %u thread%s with buffer size %lu...\n", benchmark.get_executions_description().c_str(), batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s", benchmark.m_uBufferSize);
 
     // do benchmark
     if (!Benchmark::get_stat_files(stat_filepath.c_str())) return 1;;
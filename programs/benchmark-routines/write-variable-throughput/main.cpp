@@ -6,7 +6,7 @@
 #include <string.h>
 #include <fcntl.h>
 
-int main( int argc, char **argv, char **envp ) {
+BENCH_ROUTINE("write-variable-throughput") {
 
     FrequencyBatch batch; // a whole batch of benchmarks
     FrequencyBenchmark benchmark; // a single benchmark
@@ -16,10 +16,11 @@ int main( int argc, char **argv, char **envp ) {
     benchmark.m_uBufferSize = 1;
 
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
     Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath);
-    FrequencyBatch::process_environment_variables(&batch.m_uNumSamples, &batch.m_dMinFrequency, &batch.m_dMaxFrequency);
-    FrequencyBenchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads);
+    FrequencyBatch::process_environment_variables(&batch.m_uNumSamples, &batch.m_dMinFrequency, &batch.m_dMaxFrequency, &batch.m_eSpacing, &batch.m_dSaturationThreshold, &batch.m_dSaturationTolerance);
+    FrequencyBenchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads, nullptr, &benchmark.m_bOpenLoop, &benchmark.m_oArrivals, &benchmark.m_oPacer);
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
     LOG_INFO("Running benchmark from target frequency %.0fHz to %.0fHz...\n", batch.m_dMinFrequency, batch.m_dMaxFrequency );
     
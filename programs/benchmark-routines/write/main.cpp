@@ -1,33 +1,65 @@
-#include "../../bench-tools/benchmark.h"
+#include "../../bench-tools/kernel-benchmark.h"
+#include "../../bench-tools/io-uring.h"
 
 #include <errno.h>
 #include <stdio.h>
 #include <unistd.h>
 
-int main( int argc, char **argv, char **envp ) {
+BENCH_ROUTINE("write") {
 
     Batch batch; // a whole batch of benchmarks
-    WriteBenchmark benchmark; // a single benchmark
+    WriteBenchmark* benchmark; // a single benchmark, specialized for the buffer size
+    IoUringBenchmark* io_uring = nullptr; // the benchmark if it uses io_uring instead of pwrite
     std::string data_filepath; // the file to write the results into
     std::string stat_filepath; // the file(s) containing the CPU times
-    benchmark.m_pFunction = (void_func_t)WriteBenchmark::write_single_thread;
+    size_t buffer_size; // the amount of bytes to write per buffer
+    IoBatching batching; // the buffers to write per call
+    bool use_io_uring; // whether to write with io_uring
     
     // check environment variables
+    Config::load(argc, argv);
     process_environment_variables(&data_filepath);
-    Batch::process_environment_variables(&batch.m_uNumBatches);
-    Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath);
-    WriteBenchmark::process_environment_variables(&benchmark.m_uNumExecutions, &benchmark.m_uNumThreads, &benchmark.m_uBufferSize);
+    Batch::process_environment_variables(&batch.m_uNumBatches, &batch.m_oCalibration.m_uNumRuns, &batch.m_dTargetPrecision, &batch.m_uMinBatches, &batch.m_dMaxDuration, &batch.m_dMinBatchDuration, &batch.m_oWarmup);
+    WriteBenchmark::process_environment_variables(nullptr, nullptr, &buffer_size);
+    IoBatching::process_environment_variables(&batching);
+    IoUringBenchmark::process_environment_variables(&use_io_uring);
+    if (use_io_uring && batching.get_buffers_per_call() > 1) {
+        LOG_WARN("The io_uring backend writes a single buffer per operation, ignoring BM_IO_VECTORS and BM_IO_COALESCE!\n");
+        batching = IoBatching();
+    }
+    if (use_io_uring) {
+        benchmark = io_uring = new IoUringBenchmark();
+        io_uring->m_uBufferSize = buffer_size;
+        IoUringBenchmark::process_environment_variables(nullptr, &io_uring->m_uQueueDepth, &io_uring->m_uBatchSize, &io_uring->m_bSqPoll, &io_uring->m_bRegisterBuffers, &io_uring->m_bRegisterFiles);
+    } else {
+        benchmark = create_write_benchmark(buffer_size, batching);
+    }
+    Benchmark::process_environment_variables(nullptr, nullptr, &stat_filepath, &benchmark->m_uLatencySampleInterval, &benchmark->m_oThreadPlacement);
+    WriteBenchmark::process_environment_variables(&benchmark->m_uNumExecutions, &benchmark->m_uNumThreads, nullptr, &benchmark->m_eWriteMode, &benchmark->m_sFileDirectory);
+    BufferArena::process_environment_variables(&benchmark->m_oBuffers);
     if (data_filepath.empty()) LOG_WARN("No filepath for the benchmark results specified!\n");
-    LOG_INFO("Running benchmark %u times in %u batches and %u thread%s with buffer size %lu...\n", benchmark.m_uNumExecutions, batch.m_uNumBatches, benchmark.m_uNumThreads, benchmark.m_uNumThreads == 1 ? "" : "s", benchmark.m_uBufferSize);
+    LOG_INFO("Running benchmark %s in %u batches and %u thread%s with buffer size %lu...\n", benchmark->get_executions_description().c_str(), batch.m_uNumBatches, benchmark->m_uNumThreads, benchmark->m_uNumThreads == 1 ? "" : "s", benchmark->m_uBufferSize);
+    if (io_uring != nullptr) LOG_INFO("Using io_uring with queue depth %u...\n", io_uring->m_uQueueDepth);
+    if (benchmark->m_eWriteMode != WriteMode::BUFFERED) LOG_INFO("Opening the files in %s with write mode %s...\n", benchmark->m_sFileDirectory.c_str(), benchmark->get_write_mode_name());
+    if (batching.get_buffers_per_call() > 1) LOG_INFO("Writing %u buffers per call (%s)...\n", batching.get_buffers_per_call(), batching.get_variant_name());
 
     // do benchmark
-    if (!Benchmark::get_stat_files(stat_filepath.c_str())) return 1;;
-    benchmark.open_tmp_files();
-    batch.run(benchmark);
-    benchmark.close_tmp_files();
+    if (!Benchmark::get_stat_files(stat_filepath.c_str())) {
+        delete benchmark;
+        return 1;
+    }
+    if (!benchmark->open_tmp_files() || (io_uring != nullptr && !io_uring->open_rings())) {
+        benchmark->close_tmp_files();
+        delete benchmark;
+        return 1;
+    }
+    batch.run(*benchmark);
+    if (io_uring != nullptr) io_uring->close_rings();
+    benchmark->close_tmp_files();
 
     // store result
-    if (!data_filepath.empty()) batch.to_json(data_filepath.c_str(), (environment_variables_to_json_array(envp) + ",\n    \"bufferSize\": " + std::to_string(benchmark.m_uBufferSize)).c_str());
+    if (!data_filepath.empty()) batch.to_json(data_filepath.c_str(), (environment_variables_to_json_array(envp) + ",\n    \"bufferSize\": " + std::to_string(benchmark->m_uBufferSize) + ",\n    \"writeMode\": \"" + benchmark->get_write_mode_name() + "\",\n    " + benchmark->m_oBuffers.to_json() + ",\n    " + batching.to_json(batch, benchmark->m_uBufferSize) + (io_uring == nullptr ? "" : ",\n    " + io_uring->settings_to_json())).c_str());
+    delete benchmark;
     
     // done
     return 0;
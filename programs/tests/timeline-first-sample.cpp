@@ -0,0 +1,33 @@
+#include "../bench-tools/benchmark.h"
+
+/**
+ * @brief Runs a single closed-loop FrequencyBenchmark sample with a timeline and
+ * checks that the timeline counted its calls. The counter of the first sample
+ * used to be fetched before the recorder allocated it, so it stayed empty
+ */
+
+static void empty_function( void* self, unsigned int thread_num ) {}
+
+int main( int argc, char** argv ) {
+
+    const char* args[] = {argv[0], "--config", "BM_TIMELINE_INTERVAL=100000", "--config", "BM_PACING=sleep"};
+    Config::load(5, (char**)args);
+    Benchmark::process_environment_variables();
+    if (!Benchmark::get_stat_files("/proc/self/stat")) return 1;
+
+    FrequencyBenchmark benchmark;
+    benchmark.m_pFunction = empty_function;
+    benchmark.m_dTargetFrequency = 2000;
+    Pacer::process_environment_variables(&benchmark.m_oPacer);
+    benchmark.run();
+
+    double ops = 0.0;
+    for (double throughput : benchmark.m_oTimeline.m_aThroughputs) ops += throughput;
+    if (benchmark.m_oTimeline.m_aThroughputs.empty() || ops <= 0.0) {
+        LOG_ERROR("The timeline of the first sample counted no calls!\n");
+        return 1;
+    }
+    LOG_INFO("The timeline of the first sample has %lu intervals with calls\n", benchmark.m_oTimeline.m_aThroughputs.size());
+    return 0;
+
+}
@@ -6,12 +6,19 @@ DATA_DIR=$ROOT/data
 OCCLUM_DIRECTORY=/tmp/occlum_instance
 GRAMINE_DIRECTORY=/tmp/gramine_instance
 CONFIG_DIR=/tmp/benchmarks_config
+CONFIG_FILE=$CONFIG_DIR/benchmarks.conf
 RUNTIMES=(scone-s1)
 IS_OCCLUM=false
 USE_STRACE=false
 PARAMETER_TEST_SSPINS=(0 10 50 100 200 400 600)
 PARAMETER_TEST_SSLEEPS=(4000 4000 4000 4000 4000 4000 4000)
 WRITE_BUFFER_SIZES=(1024 2048 4096 8192 65536)
+IN_PROCESS_SWEEP=false # true sweeps the write buffer sizes in a single process (one SWEEP result per runtime) instead of one run per size
+IO_URING_QUEUE_DEPTHS=(1 2 4 8 16 32)
+IO_URING_SWEEP=false # true also runs write and read with io_uring, sweeping the queue depths in a single process
+IO_BATCHING_COUNTS=(2 4 8 16 64)
+IO_BATCHING_SWEEP=false # true also runs write and read with several buffers per system call, vectored and (write only) coalesced
+WRITE_MODE_SWEEP=false # true also runs write with O_DIRECT, O_DSYNC and both, to separate the system call overhead from the page cache
 
 
 # FUNCTIONS
@@ -24,14 +31,59 @@ set_config() {
         return
     fi
     mkdir -p "$CONFIG_DIR"
-    echo "$2" > $CONFIG_DIR/$1
+    touch "$CONFIG_FILE"
+    sed -i "/^$1=/d" "$CONFIG_FILE"
+    echo "$1=$2" >> "$CONFIG_FILE"
+}
+
+# $1: the compiled Linux program to run in the Gramine enclave
+build_gramine_instance() {
+    rm -rf $GRAMINE_DIRECTORY
+    mkdir $GRAMINE_DIRECTORY
+    cp $ROOT/programs/gramine-ressources/main.manifest.template $GRAMINE_DIRECTORY/ # copy gramine manifest
+    cp $ROOT/programs/gramine-ressources/enclave-key.pem $GRAMINE_DIRECTORY/ # copy private key for signing
+    cp $ROOT/programs/gramine-ressources/Makefile $GRAMINE_DIRECTORY/ # copy Makefile
+    cp $1 $GRAMINE_DIRECTORY/main # copy compiled linux benchmark
+    (cd $GRAMINE_DIRECTORY && make clean > /dev/null && make SGX=1 > /tmp/gramine-build.log) # make manifest and token (signs stuff, calcs MRSIGNER, ...)
+}
+
+# $1: the runtime, occlum or gramine
+# $2...: the runscript of the program and its arguments
+# starts the program, links the stat file(s) of its processes and waits for it
+run_in_enclave() {
+    local r=$1
+    shift
+    if [ "$r" = "occlum" ]; then
+        "$@" &
+        sleep 3 # occlum takes a while to start its processes
+        rm -rf /tmp/stat
+        mkdir /tmp/stat
+        [ "$USE_STRACE" = "true" ] && pid=$(pgrep occlum-run) && sudo strace -c -f -p $pid &
+        for pid in $(pgrep occlum); do
+            ln -s /proc/$pid/stat /tmp/stat/$pid
+            echo "[INFO]: Using PID $pid to get the CPU time"
+        done
+        mv /tmp/stat $OCCLUM_DIRECTORY/stat
+        wait
+    else
+        "$@" &
+        sleep 1
+        local pid=$(pgrep loader)
+        if [ -z "$pid" ]; then
+            echo "[WARN]: Could not get PID of process!"
+            return 1
+        fi
+        echo "[INFO]: Using PID $pid to get the CPU time"
+        [ "$USE_STRACE" = "true" ] && sudo strace -c -f -p $pid &
+        ln -s /proc/$pid/stat /tmp/stat
+        wait
+    fi
 }
 
 # $1: dirname of benchmark routine
 # $2: non-existing directory to store benchmark result in
 run_benchmark() {
     echo "[INFO]: Running benchmark \"$1\"..."
-    local work_dir=$PWD
 
     # check if there is already data for the benchmark
     if [ -d "$2" ]; then
@@ -57,13 +109,7 @@ run_benchmark() {
             rm -f /tmp/stat
             set_config BM_STAT_FILES /tmp/stat
             set_config BM_DATA_FILEPATH /tmp/benchmark.json
-            rm -rf $GRAMINE_DIRECTORY
-            mkdir $GRAMINE_DIRECTORY
-            cp $ROOT/programs/gramine-ressources/main.manifest.template $GRAMINE_DIRECTORY/ # copy gramine manifest
-            cp $ROOT/programs/gramine-ressources/enclave-key.pem $GRAMINE_DIRECTORY/ # copy private key for signing
-            cp $ROOT/programs/gramine-ressources/Makefile $GRAMINE_DIRECTORY/ # copy Makefile
-            cp $1/linux $GRAMINE_DIRECTORY/main # copy compiled linux benchmark
-            cd $GRAMINE_DIRECTORY && make clean > /dev/null && make SGX=1 > /tmp/gramine-build.log && cd $work_dir # make manifest and token (signs stuff, calcs MRSIGNER, ...)
+            build_gramine_instance $1/linux
         else
             set_config BM_STAT_FILES /proc/self/stat
             set_config BM_DATA_FILEPATH $2/$r.json
@@ -73,30 +119,8 @@ run_benchmark() {
         echo "[INFO]: Running on $r..."
 
         # get the process ID and link its stat file(s)
-        if [ "$r" = "occlum" ]; then
-            ./$1/$r &
-            sleep 3 # occlum takes a while to start its processes
-            rm -rf /tmp/stat
-            mkdir /tmp/stat
-            [ "$USE_STRACE" = "true" ] && pid=$(pgrep occlum-run) && sudo strace -c -f -p $pid &
-            for pid in $(pgrep occlum); do
-                ln -s /proc/$pid/stat /tmp/stat/$pid
-                echo "[INFO]: Using PID $pid to get the CPU time"
-            done
-            mv /tmp/stat $OCCLUM_DIRECTORY/stat
-            wait
-        elif [ "$r" = "gramine" ]; then
-            ./$1/$r &
-            sleep 1
-            pid=$(pgrep loader)
-            if [ -z "$pid" ]; then
-                echo "[WARN]: Could not get PID of process!"
-                continue
-            fi
-            echo "[INFO]: Using PID $pid to get the CPU time"
-            [ "$USE_STRACE" = "true" ] && sudo strace -c -f -p $pid &
-            ln -s /proc/$pid/stat /tmp/stat
-            wait
+        if [ "$r" = "occlum" ] || [ "$r" = "gramine" ]; then
+            run_in_enclave $r ./$1/$r || continue
         else
             if [ "$USE_STRACE" = "true" ]; then
                 sudo strace -c -f $1/$r
@@ -129,14 +153,57 @@ run_benchmark() {
 
 
 # BENCHMARK CONFIG
-set_config BM_NUM_EXECUTIONS 100000
+set_config BM_NUM_EXECUTIONS "" # executions per batch and thread, empty calibrates them to BM_MIN_BATCH_DURATION
+set_config BM_MIN_BATCH_DURATION 50 # minimum wall-clock time of a batch in milliseconds when calibrating the executions
 set_config BM_NUM_BATCHES 100
+set_config BM_NUM_CALIBRATION_RUNS 10 # runs of an empty function to measure the harness overhead, 0 disables it
+set_config BM_TARGET_PRECISION 0 # stops once the 95% confidence interval of the mean runtime is within +-this fraction (e.g. 0.01), BM_NUM_BATCHES becomes the maximum. 0 always runs BM_NUM_BATCHES
+set_config BM_MIN_BATCHES 5 # batches run at least before the precision is checked
+set_config BM_WARMUP_WINDOW 5 # probes per window of the steady state test before the batches, 0 runs a single batch as warmup
+set_config BM_WARMUP_TOLERANCE 0.02 # maximum relative change of the median between the last two windows and over the last window
+set_config BM_MAX_WARMUP_PROBES 100 # the warmup stops without a steady state after this many probes
+set_config BM_MAX_WARMUP_DURATION 30 # or after this many seconds
+set_config BM_MAX_DURATION 0 # wall-clock budget of the batches in seconds when BM_TARGET_PRECISION is set, 0 means unlimited
 set_config BM_NUM_SAMPLES 100
 set_config BM_NUM_THREADS 8
 set_config BM_MIN_FREQUENCY 2
 set_config BM_MAX_FREQUENCY 1000000
+set_config BM_FREQUENCY_SPACING linear # linear or log steps between the frequencies, search bisects for the saturation frequency within BM_NUM_SAMPLES samples
+set_config BM_SATURATION_THRESHOLD 0.95 # a sample is saturated once it achieves less than this fraction of its target frequency
+set_config BM_SATURATION_TOLERANCE 0.05 # the search stops once the saturated frequency is at most this fraction above the sustained one
+set_config BM_LOAD_MODE closed # open starts the calls of the frequency routines at precomputed times on BM_NUM_THREADS threads, closed waits for every call
+set_config BM_ARRIVAL_PROCESS constant # constant or poisson arrivals in open-loop mode
+set_config BM_ARRIVAL_SEED 1 # the seed of the poisson arrivals
+set_config BM_PACING "" # how the frequency routines wait for the next call: sleep, spin or hybrid (sleeps and spins the calibrated wake-up latency), empty keeps the routine's mode
+set_config BM_PACING_SPIN 0 # the spin time of the hybrid pacing in microseconds, 0 uses the calibrated p99 wake-up latency
 set_config BM_BUFFER_SIZE 4096
+set_config BM_LATENCY_SAMPLE_INTERVAL 0
+set_config BM_CLOCK_SOURCE auto # auto, tsc or monotonic
+set_config BM_THREAD_PLACEMENT none # none, compact, scatter, smt or list (uses BM_CPU_LIST, e.g. 0,2,4-7)
 set_config BM_STAT_FILES /proc/self/stat
+set_config BM_THREAD_ACCOUNTING 0 # 1 records the CPU time and context switches of every thread
+set_config BM_PERF_COUNTERS 0 # 1 counts cycles, instructions, cache and TLB misses, context switches, migrations and page faults
+set_config BM_TIMELINE_INTERVAL 0 # records the throughput and CPU utilization every n microseconds, 0 disables it
+set_config BM_TRACE_FILEPATH "" # writes span events as Chrome trace JSON into this file, empty disables tracing
+set_config BM_TRACE_BUFFER_SIZE 65536 # span events kept per thread, older ones get overwritten
+set_config BM_RESULT_FILEPATH "" # streams the results of every batch into this binary file, convert it with programs/bench-export/bench-export
+set_config BM_SWEEP "" # runs every point of a grid over config keys in one process, e.g. "BM_NUM_THREADS=1,2,4;BM_BUFFER_SIZE=1024,4096"
+set_config BM_SWEEP_MODE cartesian # cartesian runs every combination, list runs the i-th values of all keys together
+set_config BM_SCALING_THREADS "" # runs the routines at these thread counts (e.g. 1,2,4,8 or auto for 1, 2, 4, ... BM_NUM_THREADS) and reports the scaling curve
+set_config BM_SCALING_COLLAPSE 0.2 # flags a collapse once the throughput drops by this fraction below its peak at more threads
+set_config BM_IO_BACKEND sync # sync issues one system call per write/read, io_uring queues them on a ring per thread
+set_config BM_IOURING_QUEUE_DEPTH 1 # the maximum amount of io_uring operations in flight per thread
+set_config BM_IOURING_BATCH 0 # the io_uring operations submitted and reaped per system call, 0 uses the queue depth
+set_config BM_IO_VECTORS 1 # the buffers per pwritev/preadv call, 1 uses pwrite/pread
+set_config BM_IO_COALESCE 1 # the writes copied into a staging buffer and written with a single pwrite, 1 disables it
+set_config BM_WRITE_MODE buffered # buffered writes into the page cache, direct (O_DIRECT), dsync (O_DSYNC) or direct_dsync bypass it
+set_config BM_WRITE_DIRECTORY /tmp # the directory of the write benchmark files, O_DIRECT needs a disk-backed file system (no tmpfs)
+set_config BM_BUFFER_BACKING heap # the memory of the per-thread buffers: heap (posix_memalign), mmap, hugetlb (MAP_HUGETLB) or thp
+set_config BM_BUFFER_ALIGNMENT 4096 # the alignment of every buffer in bytes, O_DIRECT needs at least the logical block size
+set_config BM_BUFFER_PREFAULT 1 # touch the buffers before the timed loop
+set_config BM_IOURING_SQPOLL 0 # 1 lets a kernel thread poll the submission queue
+set_config BM_IOURING_REGISTER_BUFFERS 0 # 1 registers the buffer with the rings (fixed buffer operations)
+set_config BM_IOURING_REGISTER_FILES 0 # 1 registers the files with the rings
 
 export SCONE_QUEUES=1 \
        SCONE_ETHREADS=1 \
@@ -179,6 +246,56 @@ if [ "$1" = "parameter-test" ]; then
         run_benchmark write-variable-throughput $DATA_DIR/param-test-$(($i+1))
     done
 
+elif [ "$1" = "bench" ]; then
+
+    # check if we're running in an occlum container
+    if [ -x "$(command -v occlum-g++)" ]; then
+        echo "[INFO]: Running bench on Occlum only!"
+        RUNTIMES=(occlum)
+    fi
+
+    # run the routines matching the patterns (e.g. 'write*,read') in a single process per runtime,
+    # so an enclave gets built and started only once
+    for r in ${RUNTIMES[*]}; do
+        if [ ! -f "../bench/$r" ]; then
+            echo "[WARN]: No compiled bench binary found for $r!"
+            continue
+        fi
+        for d in */ ; do mkdir -p "$DATA_DIR/${d::-1}"; done
+        echo "[INFO]: Running bench on $r..."
+        if [ "$r" = "occlum" ]; then
+
+            # the enclave writes its results into the instance directory, one file per routine
+            rm -rf $OCCLUM_DIRECTORY/stat $OCCLUM_DIRECTORY/bench-results
+            mkdir -p $OCCLUM_DIRECTORY/bench-results
+            set_config BM_STAT_FILES /host/stat
+            set_config BM_DATA_FILEPATH "/host/bench-results/{routine}.json"
+            run_in_enclave $r ../bench/$r --run "${2:-*}" || continue
+            results=$OCCLUM_DIRECTORY/bench-results
+        elif [ "$r" = "gramine" ]; then
+
+            # the manifest allows /tmp/bench-results/, one file per routine
+            rm -rf /tmp/stat /tmp/bench-results
+            mkdir -p /tmp/bench-results
+            set_config BM_STAT_FILES /tmp/stat
+            set_config BM_DATA_FILEPATH "/tmp/bench-results/{routine}.json"
+            build_gramine_instance ../bench/linux
+            run_in_enclave $r ../bench/$r --run "${2:-*}" || continue
+            results=/tmp/bench-results
+        else
+            set_config BM_STAT_FILES /proc/self/stat
+            set_config BM_DATA_FILEPATH "$DATA_DIR/{routine}/$r.json"
+            ../bench/$r --run "${2:-*}"
+            continue
+        fi
+
+        # move the results of every routine next to the ones of the other runtimes
+        for f in $results/*.json; do
+            [ -f "$f" ] || continue
+            mv "$f" "$DATA_DIR/$(basename "$f" .json)/$r.json"
+        done
+    done
+
 else
 
     # check if we're running in an occlum container
@@ -209,7 +326,11 @@ else
         if [[ $# -ge 1 && "$1" != "$d" ]]; then continue; fi
 
         # run it
-        if [ "$d" = "write" ]; then
+        if [ "$d" = "write" ] && [ "$IN_PROCESS_SWEEP" = "true" ]; then
+            set_config BM_SWEEP "BM_BUFFER_SIZE=$(IFS=,; echo "${WRITE_BUFFER_SIZES[*]}")"
+            run_benchmark $d $DATA_DIR/$d/sweep
+            set_config BM_SWEEP ""
+        elif [ "$d" = "write" ]; then
             for b in "${WRITE_BUFFER_SIZES[@]}"; do
                 echo "[INFO]: Using buffer size $b..."
                 set_config BM_BUFFER_SIZE $b
@@ -219,6 +340,37 @@ else
             run_benchmark $d $DATA_DIR/$d
         fi
 
+        # compare the synchronous path with io_uring at several queue depths
+        if [[ "$IO_URING_SWEEP" = "true" && ( "$d" = "write" || "$d" = "read" ) ]]; then
+            echo "[INFO]: Using io_uring..."
+            set_config BM_IO_BACKEND io_uring
+            set_config BM_SWEEP "BM_IOURING_QUEUE_DEPTH=$(IFS=,; echo "${IO_URING_QUEUE_DEPTHS[*]}")"
+            run_benchmark $d $DATA_DIR/$d/io_uring
+            set_config BM_SWEEP ""
+            set_config BM_IO_BACKEND sync
+        fi
+
+        # compare the page cache with direct and synchronous writes
+        if [[ "$WRITE_MODE_SWEEP" = "true" && "$d" = "write" ]]; then
+            echo "[INFO]: Using direct and synchronous writes..."
+            set_config BM_SWEEP "BM_WRITE_MODE=direct,dsync,direct_dsync"
+            run_benchmark $d $DATA_DIR/$d/write_mode
+            set_config BM_SWEEP ""
+        fi
+
+        # compare a buffer per system call with several ones, the results contain the bytes/s and system calls per byte
+        if [[ "$IO_BATCHING_SWEEP" = "true" && ( "$d" = "write" || "$d" = "read" ) ]]; then
+            echo "[INFO]: Using vectored system calls..."
+            set_config BM_SWEEP "BM_IO_VECTORS=$(IFS=,; echo "${IO_BATCHING_COUNTS[*]}")"
+            run_benchmark $d $DATA_DIR/$d/vectored
+            if [ "$d" = "write" ]; then
+                echo "[INFO]: Using coalesced writes..."
+                set_config BM_SWEEP "BM_IO_COALESCE=$(IFS=,; echo "${IO_BATCHING_COUNTS[*]}")"
+                run_benchmark $d $DATA_DIR/$d/coalesced
+            fi
+            set_config BM_SWEEP ""
+        fi
+
     done
 
 fi